@@ -0,0 +1,130 @@
+/**
+ * File: concurrent-interner-bench.cc
+ * ---------------------------
+ * Measures how concurrent_string_interner scales with the number of threads,
+ * against a string_interner behind one std::mutex. Two workloads:
+ *   hits:  every key is interned already, i.e. the lock-free lookups;
+ *   fresh: the threads intern a key set of their own plus a shared one, so
+ *          about half of the calls insert.
+ * Usage: ./concurrent-interner-bench [max_threads] [keys]
+ * Prints one line per (workload, interner, threads): Mops/s and the speedup
+ * over 1 thread. On a single core all speedups stay near 1.
+ */
+
+#include "adt/concurrent-string-interner.h"
+#include "adt/string-interner.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+/* std::mutex around string_interner, the baseline */
+struct locked_interner {
+    std::mutex lock;
+    adt::string_interner pool;
+    uint32_t intern_id(adt::string_ref s) {
+        std::lock_guard<std::mutex> guard(lock);
+        return pool.intern_id(s);
+    }
+};
+
+std::vector<std::string> makeKeys(size_t n, const char *prefix) {
+    std::vector<std::string> keys;
+    keys.reserve(n);
+    for (size_t i = 0; i != n; ++i) {
+        /* header-name-like lengths, 8 to 40 chars */
+        std::string key = prefix + std::to_string(i * 2654435761u % 1000003);
+        key.resize(8 + i % 33, 'x');
+        keys.push_back(key + std::to_string(i));
+    }
+    return keys;
+}
+
+/* Runs body(thread_index) on numThreads threads, returns the seconds taken */
+template <typename Body>
+double timeThreads(int numThreads, Body body) {
+    std::vector<std::thread> threads;
+    auto start = std::chrono::steady_clock::now();
+    for (int t = 0; t != numThreads; ++t) { threads.emplace_back(body, t); }
+    for (std::thread &thread : threads) { thread.join(); }
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+/* Interns rounds * keys.size() keys per thread, each thread from its own offset */
+template <typename Pool>
+double runHits(Pool &pool, const std::vector<std::string> &keys, int numThreads, int rounds) {
+    for (const std::string &key : keys) { pool.intern_id(key); }
+    volatile uint32_t sink = 0;
+    double seconds = timeThreads(numThreads, [&](int t) {
+        uint32_t sum = 0;
+        size_t n = keys.size();
+        for (int r = 0; r != rounds; ++r) {
+            for (size_t i = 0; i != n; ++i) { sum += pool.intern_id(keys[(i + t * 7919) % n]); }
+        }
+        sink = sink + sum;
+    });
+    return (double)rounds * keys.size() * numThreads / seconds / 1e6;
+}
+
+template <typename Pool>
+double runFresh(Pool &pool, const std::vector<std::string> &shared,
+                const std::vector<std::vector<std::string> > &own, int numThreads) {
+    double seconds = timeThreads(numThreads, [&](int t) {
+        const std::vector<std::string> &mine = own[t];
+        for (size_t i = 0; i != mine.size(); ++i) {
+            pool.intern_id(mine[i]);
+            pool.intern_id(shared[(i + t * 7919) % shared.size()]);
+        }
+    });
+    return 2.0 * own[0].size() * numThreads / seconds / 1e6;
+}
+
+} /* namespace */
+
+int main(int argc, char **argv) {
+    int maxThreads = argc > 1 ? std::atoi(argv[1]) : (int)std::thread::hardware_concurrency();
+    size_t numKeys = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 100000;
+    if (maxThreads < 1) { maxThreads = 1; }
+    std::vector<std::string> keys = makeKeys(numKeys, "x-header-");
+    std::vector<std::vector<std::string> > own;
+    for (int t = 0; t != maxThreads; ++t) {
+        own.push_back(makeKeys(numKeys, ("t" + std::to_string(t) + "-").c_str()));
+    }
+
+    std::printf("# keys=%zu hardware_threads=%u\n", numKeys, std::thread::hardware_concurrency());
+    std::printf("%-6s %-11s %7s %10s %8s\n", "work", "interner", "threads", "Mops/s", "speedup");
+    double base[4] = { 0, 0, 0, 0 };
+    for (int threads = 1;; threads = std::min(threads * 2, maxThreads)) {
+        double r[4];
+        {
+            adt::concurrent_string_interner pool;
+            r[0] = runHits(pool, keys, threads, 5);
+        }
+        {
+            locked_interner pool;
+            r[1] = runHits(pool, keys, threads, 5);
+        }
+        {
+            adt::concurrent_string_interner pool;
+            r[2] = runFresh(pool, keys, own, threads);
+        }
+        {
+            locked_interner pool;
+            r[3] = runFresh(pool, keys, own, threads);
+        }
+        const char *work[4] = { "hits", "hits", "fresh", "fresh" };
+        const char *name[4] = { "concurrent", "mutex", "concurrent", "mutex" };
+        for (int i = 0; i != 4; ++i) {
+            if (threads == 1) { base[i] = r[i]; }
+            std::printf("%-6s %-11s %7d %10.2f %8.2f\n", work[i], name[i], threads, r[i], r[i] / base[i]);
+        }
+        if (threads == maxThreads) { break; }
+    }
+    return 0;
+}
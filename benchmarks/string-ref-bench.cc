@@ -0,0 +1,358 @@
+/**
+ * File: string-ref-bench.cc
+ * ---------------------------
+ * Times the public operations of string_ref (and of the searchers built on
+ * it) over texts of 8 bytes to 64 MB (8 times larger each, up to 64 MB),
+ * drawn from four alphabets:
+ *   binary: 'a' and 'b', so patterns recur all the time;
+ *   dna:    "ACGT";
+ *   text:   English-like words, spaces, punctuation and newlines;
+ *   bytes:  all byte values but 1, 2 and 3.
+ * The searches run in three variants:
+ *   miss:   the pattern does not occur, the whole text is scanned;
+ *   last:   it occurs once, at the end where the search looks last (at the
+ *           start for the reverse searches);
+ *   common: it is taken from the text, so it occurs as often as the
+ *           alphabet makes it (from once to everywhere).
+ * The other operations have variant "-". edit_distance() runs up to 4 KB
+ * and edit_distance_within() up to 2 MB; the O(1) ones (substr() etc.)
+ * only at the smallest size.
+ * Usage: ./string-ref-bench [--min-time=ms] [--max-size=bytes]
+ *                           [--filter=op] [--alphabet=name]
+ * Prints CSV, one line per measurement: op, alphabet, variant, bytes (the
+ * text size), iterations, ns_per_op and gb_per_s (text bytes per second,
+ * best of 3 runs). Lines starting with '#' are comments.
+ */
+
+#include "adt/string-ref.h"
+#include "adt/string-searcher.h"
+#include "adt/stream-matcher.h"
+#include "adt/parallel-search.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+struct options {
+    double minSeconds = 0.05;
+    size_t maxSize = 64 << 20;
+    std::string filter;    /* substring of the op names to run */
+    std::string alphabet;  /* only this alphabet, if not empty */
+};
+
+/* Keeps the compiler from discarding a result or hoisting a call out of the
+ * timing loop */
+template <typename T>
+inline void keep(const T &value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+struct bench_runner {
+    const options &opts;
+    const char *alphabet;
+    const char *variant;
+    size_t bytes;
+
+    /* Times body(), print a CSV line: best of 3 runs, each about a third of
+     * the minimum time */
+    template <typename Body>
+    void operator()(const char *op, Body body) const {
+        if (!opts.filter.empty() && std::strstr(op, opts.filter.c_str()) == nullptr) {
+            return;
+        }
+        typedef std::chrono::steady_clock clock;
+        auto timeRun = [&](size_t iterations) {
+            auto start = clock::now();
+            for (size_t i = 0; i != iterations; ++i) { keep(body()); }
+            return std::chrono::duration<double>(clock::now() - start).count();
+        };
+        const double target = opts.minSeconds / 3;
+        size_t iterations = 1;
+        double seconds = timeRun(iterations);
+        while (seconds < target / 4) {
+            size_t scaled = seconds > 0 ? (size_t)(iterations * target / seconds) : 0;
+            iterations = std::max(iterations * 2, std::min(scaled, iterations * 100));
+            seconds = timeRun(iterations);
+        }
+        double best = seconds;
+        for (int rep = 1; rep != 3; ++rep) { best = std::min(best, timeRun(iterations)); }
+        double ns = best * 1e9 / iterations;
+        std::printf("%s,%s,%s,%zu,%zu,%.3f,%.3f\n", op, alphabet, variant, bytes,
+                    iterations, ns, bytes / ns);
+        std::fflush(stdout);
+    }
+};
+
+struct alphabet_t {
+    const char *name;
+    std::string chars;  /* every character the text may hold */
+};
+
+std::string makeText(const alphabet_t &alphabet, size_t n) {
+    std::mt19937_64 rng(n ^ alphabet.chars.size());
+    std::string text;
+    text.reserve(n + 16);
+    if (std::strcmp(alphabet.name, "text") != 0) {
+        const size_t k = alphabet.chars.size();
+        while (text.size() < n) { text += alphabet.chars[rng() % k]; }
+        return text;
+    }
+    static const char *const words[] = {
+        "the", "of", "and", "to", "a", "in", "is", "it", "you", "that", "he", "was",
+        "for", "on", "are", "with", "as", "his", "they", "be", "at", "one", "have",
+        "this", "from", "or", "had", "by", "word", "but", "what", "some", "we",
+        "can", "out", "other", "were", "all", "there", "when", "up", "use", "your",
+        "how", "said", "an", "each", "she", "which", "do", "their", "time", "if",
+        "will", "way", "about", "many", "then", "them", "write", "would", "like",
+        "string", "reference"
+    };
+    size_t lineStart = 0;
+    while (text.size() < n) {
+        /* the lower of two draws: the first words are the most frequent */
+        const char *word = words[std::min(rng() % 64, rng() % 64)];
+        size_t start = text.size();
+        text += word;
+        if (rng() % 10 == 0) { text[start] -= 'a' - 'A'; }
+        switch (rng() % 16) {
+        case 0: text += ", "; break;
+        case 1: text += ". "; break;
+        default: text += ' ';
+        }
+        if (text.size() - lineStart > 72) {
+            text.back() = '\n';
+            lineStart = text.size();
+        }
+    }
+    text.resize(n);
+    return text;
+}
+
+/* The inputs of one (alphabet, size, variant) */
+struct inputs {
+    adt::string_ref text;     /* the text searched forward */
+    adt::string_ref rtext;    /* the text searched in reverse */
+    std::string pattern;      /* 8 bytes, or the text's size if smaller */
+    char ch;
+    std::string chars;        /* for find_first_of() etc. */
+    std::string notChars;     /* for find_first_not_of() etc. */
+};
+
+void runSearches(const bench_runner &run, const inputs &in, adt::thread_pool &pool) {
+    using adt::string_ref;
+    const string_ref &text = in.text, &rtext = in.rtext;
+    const string_ref pattern(in.pattern);
+    const char ch = in.ch;
+    const adt::char_set set(in.chars), notSet(in.notChars);
+    const string_ref chars(in.chars), notChars(in.notChars);
+    std::string lowerPattern = in.pattern;
+    adt::ascii_tolower(&lowerPattern[0], lowerPattern.size());
+
+    run("find_char", [&]() { return text.find_char(ch); });
+    run("rfind_char", [&]() { return rtext.rfind_char(ch); });
+    run("count_char", [&]() { return text.count_char(ch); });
+    run("contains_char", [&]() { return text.contains(ch); });
+    run("find_str", [&]() { return text.find_str(pattern); });
+    run("rfind_str", [&]() { return rtext.rfind_str(pattern); });
+    run("contains_str", [&]() { return text.contains(pattern); });
+    run("count_str", [&]() { return text.count_str(pattern); });
+    run("count_str_nonoverlapping", [&]() { return text.count_str(pattern, false); });
+    run("find_insensitive", [&]() { return text.find_insensitive(lowerPattern); });
+    run("find_if", [&]() { return text.find_if([ch](char c) { return c == ch; }); });
+    run("rfind_if", [&]() { return rtext.rfind_if([ch](char c) { return c == ch; }); });
+    run("find_first_of_str", [&]() { return text.find_first_of(chars); });
+    run("find_first_of_set", [&]() { return text.find_first_of(set); });
+    run("find_first_not_of_str", [&]() { return text.find_first_not_of(notChars); });
+    run("find_first_not_of_set", [&]() { return text.find_first_not_of(notSet); });
+    run("find_last_of_str", [&]() { return rtext.find_last_of(chars); });
+    run("find_last_of_set", [&]() { return rtext.find_last_of(set); });
+    run("find_last_not_of_str", [&]() { return rtext.find_last_not_of(notChars); });
+    run("find_last_not_of_set", [&]() { return rtext.find_last_not_of(notSet); });
+    run("split_char", [&]() { return text.split(ch).second.size(); });
+    run("split_str", [&]() { return text.split(pattern).second.size(); });
+    run("rsplit_char", [&]() { return rtext.rsplit(ch).first.size(); });
+    run("rsplit_str", [&]() { return rtext.rsplit(pattern).first.size(); });
+
+    const adt::string_ref_searcher searcher(pattern);
+    run("searcher_find", [&]() { return searcher.find(text); });
+    run("searcher_rfind", [&]() { return searcher.rfind(rtext); });
+    run("searcher_count", [&]() { return searcher.count(text); });
+    run("stream_matcher_feed_64k", [&]() {
+        adt::stream_matcher m(pattern);
+        size_t found = 0;
+        for (size_t pos = 0; pos < text.size(); pos += 65536) {
+            m.feed(text.substr(pos, 65536), [&](size_t) { ++found; return true; });
+        }
+        return found;
+    });
+    run("parallel_count_char", [&]() { return adt::parallel_count_char(text, ch, pool); });
+    run("parallel_count_str", [&]() { return adt::parallel_count_str(text, pattern, true, pool); });
+    run("parallel_find_str", [&]() { return adt::parallel_find_str(text, pattern, pool); });
+}
+
+void runWhole(const bench_runner &run, adt::string_ref text, std::vector<char> &buffer) {
+    using adt::string_ref;
+    const std::string copy = text.to_string();
+    std::string upper = copy, edited = copy;
+    adt::ascii_toupper(&upper[0], upper.size());
+    if (!edited.empty()) { edited[edited.size() / 2] ^= 0x40; }
+    const string_ref same(copy), upperSame(upper), oneEdit(edited);
+    char *dst = buffer.data();
+
+    run("equals", [&]() { return text.equals(same); });
+    run("compare", [&]() { return text.compare(same); });
+    run("operator<", [&]() { return text < same; });
+    run("starts_with", [&]() { return text.starts_with(same); });
+    run("ends_with", [&]() { return text.ends_with(same); });
+    run("equals_insensitive", [&]() { return text.equals_insensitive(upperSame); });
+    run("compare_insensitive", [&]() { return text.compare_insensitive(upperSame); });
+    run("starts_with_insensitive", [&]() { return text.starts_with_insensitive(upperSame); });
+    run("ends_with_insensitive", [&]() { return text.ends_with_insensitive(upperSame); });
+    run("Hash", [&]() { return string_ref::Hash{}(text); });
+    run("SeededHash", [&]() { return string_ref::SeededHash{ 42 }(text); });
+    run("HashInsensitive", [&]() { return string_ref::HashInsensitive{}(text); });
+    run("to_string", [&]() { return text.to_string().size(); });
+    run("operator+", [&]() { return (std::string("key=") + text).size(); });
+    run("ascii_tolower", [&]() { adt::ascii_tolower(dst, text); return dst[0]; });
+    run("ascii_toupper", [&]() { adt::ascii_toupper(dst, text); return dst[0]; });
+    run("split_all_char", [&]() {
+        size_t tokens = 0;
+        for (string_ref token : text.split_all(' ')) { tokens += token.size(); }
+        return tokens;
+    });
+    run("split_all_str", [&]() {
+        size_t tokens = 0;
+        for (string_ref token : text.split_all(", ")) { tokens += token.size(); }
+        return tokens;
+    });
+    run("split_any_of", [&]() {
+        size_t tokens = 0;
+        for (string_ref token : text.split_any_of(" ,.\n", string_ref::npos, true)) {
+            tokens += token.size();
+        }
+        return tokens;
+    });
+    run("lines", [&]() {
+        size_t lines = 0;
+        for (string_ref line : text.lines()) { lines += line.size(); }
+        return lines;
+    });
+    if (text.size() <= 4096) {
+        run("edit_distance", [&]() { return text.edit_distance(oneEdit); });
+        run("edit_distance_insensitive", [&]() { return text.edit_distance(upperSame, false); });
+    }
+    if (text.size() <= (2 << 20)) {
+        run("edit_distance_within_8", [&]() { return text.edit_distance_within(oneEdit, 8); });
+    }
+}
+
+void runConstant(const bench_runner &run, adt::string_ref text) {
+    run("substr", [&]() { return text.substr(1, 4).size(); });
+    run("slice", [&]() { return text.slice(1, 5).size(); });
+    run("take_front", [&]() { return text.take_front(4).size(); });
+    run("take_back", [&]() { return text.take_back(4).size(); });
+    run("drop_front", [&]() { return text.drop_front(4).size(); });
+    run("drop_back", [&]() { return text.drop_back(4).size(); });
+    run("front_back", [&]() { return text.front() + text.back(); });
+}
+
+/* text with the pattern written over its end (atEnd) or its start */
+std::string planted(adt::string_ref text, const std::string &pattern, bool atEnd) {
+    std::string s = text.to_string();
+    size_t m = std::min(pattern.size(), s.size());
+    s.replace(atEnd ? s.size() - m : 0, m, pattern, 0, m);
+    return s;
+}
+
+bool parseSize(const char *arg, const char *flag, size_t &value) {
+    size_t len = std::strlen(flag);
+    if (std::strncmp(arg, flag, len) != 0) { return false; }
+    value = std::strtoull(arg + len, nullptr, 10);
+    return true;
+}
+
+} /* namespace */
+
+int main(int argc, char **argv) {
+    options opts;
+    for (int i = 1; i < argc; ++i) {
+        size_t value;
+        if (parseSize(argv[i], "--min-time=", value)) {
+            opts.minSeconds = value / 1000.0;
+        } else if (parseSize(argv[i], "--max-size=", value)) {
+            opts.maxSize = value;
+        } else if (std::strncmp(argv[i], "--filter=", 9) == 0) {
+            opts.filter = argv[i] + 9;
+        } else if (std::strncmp(argv[i], "--alphabet=", 11) == 0) {
+            opts.alphabet = argv[i] + 11;
+        } else {
+            std::fprintf(stderr, "usage: %s [--min-time=ms] [--max-size=bytes] "
+                         "[--filter=op] [--alphabet=binary|dna|text|bytes]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    std::vector<alphabet_t> alphabets = {
+        { "binary", "ab" },
+        { "dna", "ACGT" },
+        { "text", "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ ,.\n" },
+        { "bytes", "" }
+    };
+    for (int c = 0; c != 256; ++c) {
+        if (c < 1 || c > 3) { alphabets.back().chars += (char)c; }
+    }
+    /* the pattern of the miss and last variants ends with \x01, which occurs
+     * in no text; \x02 and \x03 neither */
+    const std::string absentChars = "\x01\x02\x03";
+
+    adt::thread_pool &pool = adt::thread_pool::shared();
+    std::printf("# min_time_ms=%.0f max_size=%zu threads=%zu\n",
+                opts.minSeconds * 1000, opts.maxSize, pool.size());
+    std::printf("op,alphabet,variant,bytes,iterations,ns_per_op,gb_per_s\n");
+    std::vector<char> buffer(opts.maxSize);
+    for (const alphabet_t &alphabet : alphabets) {
+        if (!opts.alphabet.empty() && opts.alphabet != alphabet.name) { continue; }
+        const std::string full = makeText(alphabet, opts.maxSize);
+        for (size_t size = std::min<size_t>(8, opts.maxSize);;
+             size = std::min(size * 8, opts.maxSize)) {
+            const adt::string_ref text(full.data(), size);
+            const std::string common = text.substr(0, 8).to_string();
+            const std::string absent = common.substr(0, common.size() - 1) + '\x01';
+            const std::string atEnd = planted(text, absent, true);
+            const std::string atStart = planted(text, absent, false);
+
+            inputs in;
+            in.text = text;
+            in.rtext = text;
+            in.pattern = absent;
+            in.ch = '\x01';
+            in.chars = absentChars;
+            in.notChars = alphabet.chars;
+            runSearches(bench_runner{ opts, alphabet.name, "miss", size }, in, pool);
+
+            in.text = atEnd;
+            in.rtext = atStart;
+            runSearches(bench_runner{ opts, alphabet.name, "last", size }, in, pool);
+
+            in.text = text;
+            in.rtext = text;
+            in.pattern = common;
+            in.ch = text[size / 2];
+            in.chars = text.substr(size / 2, 3).to_string();
+            in.notChars = absentChars;
+            runSearches(bench_runner{ opts, alphabet.name, "common", size }, in, pool);
+
+            bench_runner run{ opts, alphabet.name, "-", size };
+            runWhole(run, text, buffer);
+            if (size <= 8) { runConstant(run, text); }
+            if (size == opts.maxSize) { break; }
+        }
+    }
+    return 0;
+}
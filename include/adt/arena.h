@@ -0,0 +1,99 @@
+/**
+ * File: arena.h
+ * ---------------------------
+ * Exports class arena, a bump allocator: memory is handed out from large
+ * chunks by moving a pointer, and is only given back all at once, when the
+ * arena is reset or destroyed. Use it to own many small objects (e.g. the
+ * characters behind string_refs) that die together.
+ */
+
+#ifndef ARENA_H
+#define ARENA_H
+
+#include "adt/string-ref.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace adt {
+    /* Bump allocator, frees everything at once */
+    class arena;
+}
+
+class adt::arena {
+public:
+    /**
+     * Constructor.
+     * Usage: adt::arena a; adt::arena big(1 << 20);
+     * ---------------------------
+     * No memory is allocated until the first allocation. Chunks start at
+     * chunk_size bytes and double in size up to max_chunk_size; a request
+     * larger than that gets a chunk of its own.
+     */
+    explicit arena(size_t chunk_size = 4096);
+    /* the memory handed out belongs to the arena: no copy, no move */
+    arena(const arena &) = delete;
+    arena &operator=(const arena &) = delete;
+
+    static const size_t max_chunk_size = (size_t)1 << 20;
+
+    /* Returns n bytes aligned to align (a power of two), never NULL. They
+     * stay valid until reset() or the arena's destruction. */
+    void *allocate(size_t n, size_t align = alignof(std::max_align_t)) {
+        uintptr_t p = ((uintptr_t)cur + (align - 1)) & ~(uintptr_t)(align - 1);
+        if (cur == nullptr || p > (uintptr_t)end || n > (uintptr_t)end - p) {
+            return allocateSlow(n, align);
+        }
+        cur = (char *)p + n;
+        used += n;
+        return (void *)p;
+    }
+
+    /* Returns n unaligned bytes, for characters */
+    char *allocate_chars(size_t n) {
+        return static_cast<char *>(allocate(n, 1));
+    }
+
+    /* Copies the characters of s into the arena, followed by a '\0' (so the
+     * result's ptr() is also a C-string), and returns the copy */
+    string_ref copy(string_ref s) {
+        char *p = allocate_chars(s.size() + 1);
+        if (!s.empty()) { std::memcpy(p, s.ptr(), s.size()); }
+        p[s.size()] = '\0';
+        return string_ref(p, s.size());
+    }
+
+    /* Resizes the latest allocation, [p, p + old_size), to new_size bytes in
+     * place: shrinking gives the bytes back to the arena, growing needs room
+     * left in the chunk. Returns false (and changes nothing) if p is not the
+     * latest allocation or there is no room. */
+    bool try_resize(const void *p, size_t old_size, size_t new_size) {
+        if ((const char *)p + old_size != cur
+            || (new_size > old_size && new_size - old_size > (size_t)(end - cur))) {
+            return false;
+        }
+        cur = cur - old_size + new_size;
+        used = used - old_size + new_size;
+        return true;
+    }
+
+    /* Bytes handed out so far, and bytes reserved from the heap */
+    size_t bytes_used() const { return used; }
+    size_t bytes_reserved() const { return reserved; }
+
+    /* Invalidates everything allocated, keeping the largest chunk for reuse */
+    void reset();
+
+private:
+    char *cur;   /* bump pointer in the current chunk */
+    char *end;   /* end of the current chunk */
+    size_t nextChunkSize;
+    size_t used, reserved;
+    std::vector<std::unique_ptr<char[]> > chunks;
+    std::vector<size_t> chunkSizes;
+
+    void *allocateSlow(size_t n, size_t align);
+};
+
+#endif
@@ -0,0 +1,44 @@
+/**
+ * File: compiler.h
+ * ---------------------------
+ * Compiler support macros shared by the headers.
+ */
+
+#ifndef ADT_COMPILER_H
+#define ADT_COMPILER_H
+
+/* ADT_IS_CONSTANT_EVALUATED() is true while the compiler evaluates a
+ * constant expression, and false at run time (where the test is folded
+ * away). constexpr functions use it to take a plain loop at compile time
+ * instead of memcmp() or a vectorized kernel, which cannot be evaluated
+ * there. Compilers without the builtin (GCC < 9, Clang < 9) get false, so
+ * the functions still work at run time but not in constant expressions.
+ * ADT_HAS_CONSTANT_EVALUATED tells which: 1 if string_ref, hash_bytes() and
+ * keyword_map are usable in constant expressions, else 0. */
+#if defined(__has_builtin)
+#  if __has_builtin(__builtin_is_constant_evaluated)
+#    define ADT_IS_CONSTANT_EVALUATED() __builtin_is_constant_evaluated()
+#  endif
+#endif
+#if !defined(ADT_IS_CONSTANT_EVALUATED) && defined(__GNUC__) && !defined(__clang__) \
+    && __GNUC__ >= 9
+#  define ADT_IS_CONSTANT_EVALUATED() __builtin_is_constant_evaluated()
+#endif
+#ifdef ADT_IS_CONSTANT_EVALUATED
+#  define ADT_HAS_CONSTANT_EVALUATED 1
+#else
+#  define ADT_IS_CONSTANT_EVALUATED() false
+#  define ADT_HAS_CONSTANT_EVALUATED 0
+#endif
+
+/* ADT_CONSTEXPR marks the functions that are constexpr only thanks to
+ * ADT_IS_CONSTANT_EVALUATED(), and the constexpr functions calling them.
+ * Without the builtin they reach run-time code on every path, which makes a
+ * constexpr function ill-formed, so they are plain inline functions. */
+#if ADT_HAS_CONSTANT_EVALUATED
+#  define ADT_CONSTEXPR constexpr
+#else
+#  define ADT_CONSTEXPR inline
+#endif
+
+#endif
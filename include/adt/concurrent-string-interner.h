@@ -0,0 +1,128 @@
+/**
+ * File: concurrent-string-interner.h
+ * ---------------------------
+ * Exports class concurrent_string_interner, the thread-safe counterpart of
+ * string_interner, to be shared by many threads.
+ * Strings are spread over shards by hash. Each shard has its own lock,
+ * arena and open-addressing table. A shard publishes its entries and its
+ * tables with release stores, so looking up a string that is already
+ * interned takes no lock and writes no shared memory: it scales with the
+ * number of threads. Only the first intern of a string locks its shard. A
+ * grown table replaces the old one atomically, and old tables are kept
+ * until the interner is destroyed (readers may still be probing them).
+ */
+
+#ifndef CONCURRENT_STRING_INTERNER_H
+#define CONCURRENT_STRING_INTERNER_H
+
+#include "adt/string-ref.h"
+#include "adt/arena.h"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace adt {
+    /* Deduplicating string pool, thread-safe */
+    class concurrent_string_interner;
+}
+
+class adt::concurrent_string_interner {
+public:
+    /* id of no string, returned by find_id() if the string is not interned */
+    static const uint32_t invalid_id = UINT32_MAX;
+
+    /* Memory use statistics, see stats(). Hits are not counted, to keep the
+     * lookups free of shared writes. */
+    struct statistics {
+        size_t strings;        /* distinct strings, i.e. size() */
+        size_t unique_bytes;   /* characters stored, '\0's not counted */
+        size_t arena_bytes;    /* bytes reserved by the shards' arenas */
+        size_t table_bytes;    /* bytes of the hash tables (retired ones too)
+                                  and the id index */
+    };
+
+    /* Creates an empty pool of shard_count shards (rounded up to a power of
+     * 2); more shards mean less contention when new strings are interned */
+    explicit concurrent_string_interner(size_t shard_count = 64);
+    ~concurrent_string_interner();
+    concurrent_string_interner(const concurrent_string_interner &) = delete;
+    concurrent_string_interner &operator=(const concurrent_string_interner &) = delete;
+
+    /**
+     * Methods: intern(), intern_id()
+     * Usage: adt::string_ref name = pool.intern(header.first);
+     * ---------------------------
+     * The same as string_interner's, std::length_error included, and can be
+     * called from any thread. The ids are dense, but a string's id depends on
+     * the order in which the threads happen to intern.
+     */
+    string_ref intern(string_ref s);
+    uint32_t intern_id(string_ref s);
+
+    /* Returns the id of s if it is interned, else invalid_id; never locks */
+    uint32_t find_id(string_ref s) const;
+
+    /* Returns the string with the given id, as returned to any thread */
+    string_ref operator[](uint32_t id) const;
+
+    /* Number of distinct strings interned */
+    size_t size() const { return nextId.load(std::memory_order_relaxed); }
+
+    /* Locks the shards one at a time, so the numbers are a snapshot only if
+     * no thread is interning */
+    statistics stats() const;
+
+private:
+    /* A string and its cached hash, in the arena of its shard; the
+     * characters (null-terminated) follow the header */
+    struct entry {
+        uint64_t hash;
+        uint32_t len;
+        uint32_t id;
+        const char *chars() const { return reinterpret_cast<const char *>(this + 1); }
+        string_ref str() const { return string_ref(chars(), len); }
+    };
+
+    struct table {
+        size_t mask;  /* size - 1, the size being a power of 2 */
+        std::unique_ptr<std::atomic<const entry *>[]> slots;  /* NULL if empty */
+        explicit table(size_t size);
+    };
+
+    struct shard {
+        std::atomic<const table *> current;
+        std::mutex lock;    /* serializes inserts; readers never take it */
+        size_t used = 0;
+        size_t bytes = 0;   /* characters stored */
+        arena pool;
+        std::vector<std::unique_ptr<table> > tables;  /* the current one last */
+        shard();
+    };
+
+    /* id -> entry index: segment k holds 1024 << k ids, so the segments never
+     * move once allocated and 23 of them cover all 32-bit ids */
+    static const size_t firstSegment = 1024;
+    static const int numSegments = 23;
+
+    std::unique_ptr<shard[]> shards;
+    int shardBits;
+    std::atomic<uint32_t> nextId;
+    std::atomic<std::atomic<const entry *> *> segments[numSegments];
+    std::mutex segmentLock;
+
+    shard &shardOf(uint64_t hash) const {
+        return shards[shardBits == 0 ? 0 : hash >> (64 - shardBits)];
+    }
+    static const entry *probe(const table *t, string_ref s, uint64_t hash);
+    /* probes without locking first, and only locks to insert */
+    const entry *findOrInsert(string_ref s);
+    const entry *insert(shard &sh, string_ref s, uint64_t hash);
+    /* the index slot of an id; idSlot() is NULL if the segment was never
+     * allocated, which allocateIdSlot() does if needed */
+    std::atomic<const entry *> *idSlot(uint32_t id) const;
+    std::atomic<const entry *> *allocateIdSlot(uint32_t id);
+};
+
+#endif
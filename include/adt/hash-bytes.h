@@ -0,0 +1,169 @@
+/**
+ * File: hash-bytes.h
+ * ---------------------------
+ * Exports adt::hash_bytes(), a fast non-cryptographic 64-bit hash over a
+ * (pointer, length) pair; it is the hash behind string_ref::Hash. The
+ * algorithm is wyhash (final version 4, by Wang Yi): inputs of up to 16
+ * bytes take a branchy fast path of two multiplications, longer ones are
+ * consumed 48 bytes per round on three independent lanes. Bytes are read as
+ * little-endian words, so for a given seed the values are the same across
+ * processes, builds and platforms, and can be persisted or used to shard.
+ * The functions are constexpr: in a constant expression the words are
+ * assembled byte by byte instead, to the same values.
+ */
+
+#ifndef HASH_BYTES_H
+#define HASH_BYTES_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include "adt/compiler.h"
+
+namespace adt {
+namespace hash_detail {
+    constexpr uint64_t secret[4] = {
+        0x2d358dccaa6c78a5ull, 0x8bb84b93962eacc9ull,
+        0x4b33a62ed433d4a3ull, 0x4d5a2da51de1aa47ull
+    };
+
+    /* 64x64 -> 128-bit multiplication, low half into a, high half into b */
+    constexpr void mum(uint64_t &a, uint64_t &b) {
+#ifdef __SIZEOF_INT128__
+        __uint128_t r = (__uint128_t)a * b;
+        a = (uint64_t)r;
+        b = (uint64_t)(r >> 64);
+#else
+        uint64_t ha = a >> 32, hb = b >> 32, la = (uint32_t)a, lb = (uint32_t)b;
+        uint64_t rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb;
+        uint64_t t = rl + (rm0 << 32), lo = t + (rm1 << 32);
+        uint64_t c = (t < rl) + (lo < t);
+        a = lo;
+        b = rh + (rm0 >> 32) + (rm1 >> 32) + c;
+#endif
+    }
+
+    constexpr uint64_t mix(uint64_t a, uint64_t b) {
+        mum(a, b);
+        return a ^ b;
+    }
+
+    /* little-endian value of the n bytes at p, for constant expressions */
+    constexpr uint64_t readBytes(const char *p, int n) {
+        uint64_t v = 0;
+        for (int i = n - 1; i >= 0; --i) { v = (v << 8) | (unsigned char)p[i]; }
+        return v;
+    }
+
+    /* little-endian loads of 8, 4 and 1-3 bytes */
+    constexpr uint64_t read8(const char *p) {
+        if (ADT_IS_CONSTANT_EVALUATED()) { return readBytes(p, 8); }
+        uint64_t v = 0;
+        std::memcpy(&v, p, 8);
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+        v = __builtin_bswap64(v);
+#endif
+        return v;
+    }
+
+    constexpr uint64_t read4(const char *p) {
+        if (ADT_IS_CONSTANT_EVALUATED()) { return readBytes(p, 4); }
+        uint32_t v = 0;
+        std::memcpy(&v, p, 4);
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+        v = __builtin_bswap32(v);
+#endif
+        return v;
+    }
+
+    constexpr uint64_t read3(const char *p, size_t k) {
+        return ((uint64_t)(unsigned char)p[0] << 16)
+               | ((uint64_t)(unsigned char)p[k >> 1] << 8) | (unsigned char)p[k - 1];
+    }
+
+    /* Lower-cases the ASCII letters among the 8 bytes of x at once: the range
+     * check is done on the low 7 bits of each byte, which cannot carry into
+     * the next byte, and bytes from 0x80 up are left out */
+    constexpr uint64_t fold_case(uint64_t x) {
+        const uint64_t ones = 0x0101010101010101ull;
+        uint64_t low7 = x & (0x7f * ones);
+        uint64_t fromA = low7 + (0x80 - 'A') * ones;      /* top bit: >= 'A' */
+        uint64_t pastZ = low7 + (0x80 - 'Z' - 1) * ones;  /* top bit: > 'Z' */
+        uint64_t upper = (fromA ^ pastZ) & ~x & (0x80 * ones);
+        return x | (upper >> 2);
+    }
+
+    template <bool Fold>
+    constexpr uint64_t word(uint64_t x) {
+        return Fold ? fold_case(x) : x;
+    }
+
+    /* The hash behind hash_bytes() and hash_bytes_insensitive(); if Fold,
+     * every word read is lower-cased first */
+    template <bool Fold>
+    constexpr uint64_t hash(const char *key, size_t len, uint64_t seed) {
+        const char *p = key;
+        seed ^= mix(seed ^ secret[0], secret[1]);
+        uint64_t a = 0, b = 0;
+        if (len <= 16) {
+            if (len >= 4) {
+                a = word<Fold>((read4(p) << 32) | read4(p + ((len >> 3) << 2)));
+                b = word<Fold>((read4(p + len - 4) << 32)
+                               | read4(p + len - 4 - ((len >> 3) << 2)));
+            } else if (len > 0) {
+                a = word<Fold>(read3(p, len));
+            }
+        } else {
+            size_t i = len;
+            if (i > 48) {
+                uint64_t see1 = seed, see2 = seed;
+                do {
+                    seed = mix(word<Fold>(read8(p)) ^ secret[1],
+                               word<Fold>(read8(p + 8)) ^ seed);
+                    see1 = mix(word<Fold>(read8(p + 16)) ^ secret[2],
+                               word<Fold>(read8(p + 24)) ^ see1);
+                    see2 = mix(word<Fold>(read8(p + 32)) ^ secret[3],
+                               word<Fold>(read8(p + 40)) ^ see2);
+                    p += 48;
+                    i -= 48;
+                } while (i > 48);
+                seed ^= see1 ^ see2;
+            }
+            while (i > 16) {
+                seed = mix(word<Fold>(read8(p)) ^ secret[1],
+                           word<Fold>(read8(p + 8)) ^ seed);
+                i -= 16;
+                p += 16;
+            }
+            a = word<Fold>(read8(p + i - 16));
+            b = word<Fold>(read8(p + i - 8));
+        }
+        a ^= secret[1];
+        b ^= seed;
+        mum(a, b);
+        return mix(a ^ secret[0] ^ len, b ^ secret[1]);
+    }
+}
+
+    /**
+     * Function: hash_bytes()
+     * Usage: uint64_t h = adt::hash_bytes(ptr, len);
+     *        uint64_t shard = adt::hash_bytes(ptr, len, seed) % numShards;
+     * ---------------------------
+     * Hashes the bytes [p, p + len) with a seed, never allocates. p may be
+     * NULL if len is 0.
+     */
+    constexpr uint64_t hash_bytes(const char *key, size_t len, uint64_t seed = 0) {
+        return hash_detail::hash<false>(key, len, seed);
+    }
+
+    /* The same as hash_bytes(), but ASCII letters hash the same in either
+     * case: the value is hash_bytes() of the lower-cased bytes, computed by
+     * folding the case of each word read, with no copy */
+    constexpr uint64_t hash_bytes_insensitive(const char *key, size_t len,
+                                              uint64_t seed = 0) {
+        return hash_detail::hash<true>(key, len, seed);
+    }
+}
+
+#endif
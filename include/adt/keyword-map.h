@@ -0,0 +1,204 @@
+/**
+ * File: keyword-map.h
+ * ---------------------------
+ * Exports class template keyword_map, a map from a fixed set of string keys
+ * (HTTP methods, header names, command verbs...) to values, built at compile
+ * time as a minimal perfect hash table: N keys in N slots, no collisions.
+ * A lookup hashes the key once, reads its bucket's displacement and then
+ * the one slot the key can be in, and compares the key there (a memcmp()).
+ * Construction is "hash and displace" (CHD): the keys are spread over N
+ * buckets by their hash, and each bucket, largest first, gets the smallest
+ * displacement that sends all its keys to free slots.
+ */
+
+#ifndef KEYWORD_MAP_H
+#define KEYWORD_MAP_H
+
+#include "adt/string-ref.h"
+#include <cstdint>
+#include <stdexcept>
+
+namespace adt {
+    /* A key and its value, to build a keyword_map from */
+    template <typename Value>
+    struct keyword_entry {
+        string_ref key;
+        Value value;
+    };
+
+    /* Compile-time minimal perfect hash map keyed by string_ref */
+    template <typename Value, size_t N, bool CaseSensitive = true>
+    class keyword_map;
+}
+
+template <typename Value, size_t N, bool CaseSensitive>
+class adt::keyword_map {
+    static_assert(N > 0, "a keyword_map needs at least one key");
+    static_assert(N <= UINT32_MAX, "too many keys");
+
+public:
+    /**
+     * Constructor.
+     * Usage: enum method_t { GET, HEAD, POST };
+     *        constexpr adt::keyword_map<method_t, 3> methods({
+     *            { "GET", GET }, { "HEAD", HEAD }, { "POST", POST } });
+     *        constexpr auto verbs = adt::make_keyword_map<int>({ { "ls", 1 }, ... });
+     *        const method_t *m = methods.find(request.method);
+     * ---------------------------
+     * Builds the table, at compile time if the map is constexpr (the keys'
+     * characters must then be string literals; the map refers to them).
+     * The keys must be distinct (ASCII case not counted if !CaseSensitive):
+     * duplicates make a constexpr map ill-formed and throw std::logic_error
+     * at run time. Keys no displacement can spread over the slots (about
+     * never, unless distinct keys share a 64-bit hash) throw
+     * std::runtime_error the same way. Value must be a literal type that can
+     * be default constructed and assigned, e.g. an integer, an enum or a
+     * function pointer.
+     * Building takes time about linear in N.
+     */
+    constexpr explicit keyword_map(const keyword_entry<Value> (&entries)[N]) {
+        uint64_t hashes[N] = {};
+        uint32_t bucketSize[N] = {};
+        for (size_t i = 0; i != N; ++i) {
+            hashes[i] = hashOf(entries[i].key);
+            ++bucketSize[bucketOf(hashes[i])];
+        }
+        /* the keys grouped by bucket: bucket b's are order[first[b], first[b + 1]) */
+        uint32_t first[N + 1] = {};
+        for (size_t b = 0; b != N; ++b) { first[b + 1] = first[b] + bucketSize[b]; }
+        uint32_t order[N] = {}, fill[N] = {};
+        size_t largest = 0;
+        for (size_t i = 0; i != N; ++i) {
+            size_t b = bucketOf(hashes[i]);
+            order[first[b] + fill[b]++] = (uint32_t)i;
+            largest = bucketSize[b] > largest ? bucketSize[b] : largest;
+        }
+        bool taken[N] = {};
+        for (size_t size = largest; size > 0; --size) {
+            for (size_t b = 0; b != N; ++b) {
+                if (bucketSize[b] != size) { continue; }
+                checkHashes(entries, hashes, order + first[b], size);
+                uint32_t d = 0;
+                while (d != maxDisplacement && !fits(hashes, order + first[b], size, d, taken)) {
+                    ++d;
+                }
+                if (d == maxDisplacement) {
+                    throw std::runtime_error("keyword_map: no displacement fits the keys");
+                }
+                displacement[b] = d;
+                for (size_t k = 0; k != size; ++k) {
+                    size_t i = order[first[b] + k], slot = slotOf(hashes[i], d);
+                    taken[slot] = true;
+                    keys[slot] = entries[i].key;
+                    values[slot] = entries[i].value;
+                }
+            }
+        }
+    }
+
+    /* Number of keys */
+    constexpr size_t size() const { return N; }
+
+    /**
+     * Method: find()
+     * Usage: if (const method_t *m = methods.find(token)) { ... }
+     * ---------------------------
+     * Returns a pointer to the value of key, or NULL if key is not one of
+     * the map's. Usable in constant expressions if CaseSensitive.
+     */
+    constexpr const Value *find(string_ref key) const {
+        /* the slot depends on the displacement, the few bits per key that
+         * make the hash perfect: the two loads are dependent by design */
+        uint64_t h = hashOf(key);
+        size_t slot = slotOf(h, displacement[bucketOf(h)]);
+        return matches(keys[slot], key) ? &values[slot] : nullptr;
+    }
+
+    constexpr bool contains(string_ref key) const { return find(key) != nullptr; }
+
+    /* Returns the value of key, or fallback if key is not one of the map's */
+    constexpr Value lookup(string_ref key, Value fallback) const {
+        const Value *value = find(key);
+        return value ? *value : fallback;
+    }
+
+private:
+    /* A bucket of k keys fits after d tries with probability about
+     * (free slots / N)^k, so the last ones take about N tries */
+    static const uint32_t maxDisplacement = N < 4096 ? 1u << 16 : (uint32_t)(16 * N);
+
+    string_ref keys[N] = {};
+    Value values[N] = {};
+    uint32_t displacement[N] = {};  /* per bucket */
+
+    static constexpr uint64_t hashOf(string_ref key) {
+        return CaseSensitive ? hash_bytes(key.ptr(), key.size())
+                             : hash_bytes_insensitive(key.ptr(), key.size());
+    }
+    static constexpr bool matches(string_ref stored, string_ref key) {
+        return CaseSensitive ? stored == key : stored.equals_insensitive(key);
+    }
+    /* maps a 32-bit value to [0, N) with a multiplication, not a division */
+    static constexpr size_t reduce(uint32_t x) {
+        return (size_t)(((uint64_t)x * N) >> 32);
+    }
+    static constexpr size_t bucketOf(uint64_t h) { return reduce((uint32_t)(h >> 32)); }
+    /* the slot of a key in a bucket of displacement d: its hash remixed with
+     * d, so that every d gives the bucket's keys new, independent slots */
+    static constexpr size_t slotOf(uint64_t h, uint32_t d) {
+        uint64_t x = h ^ (d * 0x9e3779b97f4a7c15ull);
+        x ^= x >> 32;
+        x *= 0xd6e8feb86659fd93ull;
+        x ^= x >> 32;
+        return reduce((uint32_t)x);
+    }
+    /* Throws if two of the keys bucket[0..size) have the same hash, as no
+     * displacement can then separate them: duplicates are caught here */
+    static constexpr void checkHashes(const keyword_entry<Value> (&entries)[N],
+                                      const uint64_t *hashes, const uint32_t *bucket,
+                                      size_t size) {
+        for (size_t k = 0; k != size; ++k) {
+            for (size_t j = 0; j != k; ++j) {
+                if (hashes[bucket[j]] != hashes[bucket[k]]) { continue; }
+                if (matches(entries[bucket[j]].key, entries[bucket[k]].key)) {
+                    throw std::logic_error("keyword_map: duplicate keys");
+                }
+                throw std::runtime_error("keyword_map: two keys have the same hash");
+            }
+        }
+    }
+    /* Checks if the keys bucket[0..size) go to distinct free slots with d */
+    static constexpr bool fits(const uint64_t *hashes, const uint32_t *bucket,
+                               size_t size, uint32_t d, const bool *taken) {
+        for (size_t k = 0; k != size; ++k) {
+            size_t slot = slotOf(hashes[bucket[k]], d);
+            if (taken[slot]) { return false; }
+            for (size_t j = 0; j != k; ++j) {
+                if (slotOf(hashes[bucket[j]], d) == slot) { return false; }
+            }
+        }
+        return true;
+    }
+};
+
+template <typename Value, size_t N, bool CaseSensitive>
+const uint32_t adt::keyword_map<Value, N, CaseSensitive>::maxDisplacement;
+
+namespace adt {
+    /* Deduces the map's size from the entries.
+     * Usage: constexpr auto verbs = adt::make_keyword_map<int>({
+     *            { "get", 1 }, { "set", 2 } }); */
+    template <typename Value, size_t N>
+    constexpr keyword_map<Value, N> make_keyword_map(const keyword_entry<Value> (&entries)[N]) {
+        return keyword_map<Value, N>(entries);
+    }
+
+    /* The same, with keys matched regardless of their ASCII case */
+    template <typename Value, size_t N>
+    constexpr keyword_map<Value, N, false>
+    make_keyword_map_insensitive(const keyword_entry<Value> (&entries)[N]) {
+        return keyword_map<Value, N, false>(entries);
+    }
+}
+
+#endif
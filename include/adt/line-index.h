@@ -0,0 +1,133 @@
+/**
+ * File: line-index.h
+ * ---------------------------
+ * Exports class line_index, the newlines of a text found in one vectorized
+ * pass and kept as a bitmap (one 64-bit word per 64-byte block) plus a
+ * running count per block. Iterating its lines then costs a bit scan per
+ * line, and the i-th line or the line of a byte offset is found without
+ * rescanning the text. The lines are the same as string_ref::lines()'s.
+ * Like string_ref, it does not own the text's characters.
+ */
+
+#ifndef LINE_INDEX_H
+#define LINE_INDEX_H
+
+#include "adt/string-ref.h"
+#include <cstdint>
+#include <iterator>
+#include <vector>
+
+namespace adt {
+    /* Bitmap of the newlines of a text */
+    class line_index;
+}
+
+class adt::line_index {
+public:
+    class iterator;
+    typedef iterator const_iterator;
+
+    /**
+     * Constructor.
+     * Usage: adt::mapped_file log("app.log");
+     *        adt::line_index index(log.view());
+     *        for (adt::string_ref line : index) { ... }
+     *        adt::string_ref tenth = index.line(9);
+     * ---------------------------
+     * Scans the text for '\n's, a vector at a time. Takes about n / 4 bytes
+     * of memory for a text of n bytes.
+     */
+    explicit line_index(string_ref text);
+
+    /* Number of lines */
+    size_t size() const { return numLines; }
+    string_ref text() const { return str; }
+
+    /* Returns the i-th line (from 0), which must be < size() */
+    string_ref line(size_t i) const;
+
+    /* Returns the number of the line that the byte at offset belongs to (a
+     * '\n' belongs to the line it ends); offset must be < text().size() */
+    size_t line_of(size_t offset) const;
+
+    iterator begin() const;
+    iterator end() const;
+
+private:
+    string_ref str;
+    std::vector<uint64_t> bits;      /* bit j of bits[k]: str[64 * k + j] == '\n' */
+    std::vector<size_t> countBefore; /* '\n's in the blocks before block k */
+    size_t numNewlines;
+    size_t numLines;
+
+    /* Returns the offset of the i-th '\n' (from 0) */
+    size_t select(size_t i) const;
+    /* Returns the line [start, nl) without its '\r' if any */
+    string_ref lineEndingAt(size_t start, size_t nl) const {
+        if (nl > start && str[nl - 1] == '\r') { --nl; }
+        return string_ref(str.ptr() + start, nl - start);
+    }
+};
+
+class adt::line_index::iterator {
+public:
+    typedef std::forward_iterator_tag iterator_category;
+    typedef string_ref value_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef const string_ref *pointer;
+    typedef const string_ref &reference;
+
+    iterator() : index(nullptr), start(0), block(0), pending(0), atEnd(true) {}
+
+    reference operator*() const { return line; }
+    pointer operator->() const { return &line; }
+    iterator &operator++() { advance(); return *this; }
+    iterator operator++(int) { iterator old = *this; advance(); return old; }
+    bool operator==(const iterator &rhs) const {
+        return atEnd == rhs.atEnd && (atEnd || line.ptr() == rhs.line.ptr());
+    }
+    bool operator!=(const iterator &rhs) const { return !(*this == rhs); }
+
+private:
+    friend class line_index;
+    const line_index *index;
+    string_ref line;
+    size_t start;      /* where the next line starts */
+    size_t block;      /* the block pending is from */
+    uint64_t pending;  /* the newlines of the block not consumed yet */
+    bool atEnd;
+
+    explicit iterator(const line_index *index)
+    : index(index), start(0), block(0),
+      pending(index->bits.empty() ? 0 : index->bits[0]), atEnd(false) {
+        advance();
+    }
+
+    void advance() {
+        const size_t len = index->str.size();
+        while (pending == 0 && block + 1 < index->bits.size()) {
+            pending = index->bits[++block];
+        }
+        if (pending != 0) {
+            size_t nl = block * 64 + __builtin_ctzll(pending);
+            pending &= pending - 1;
+            line = index->lineEndingAt(start, nl);
+            start = nl + 1;
+        } else if (start < len) {
+            line = string_ref(index->str.ptr() + start, len - start);
+            start = len;
+        } else {
+            atEnd = true;
+        }
+    }
+};
+
+inline adt::line_index::iterator adt::line_index::begin() const {
+    return iterator(this);
+}
+
+inline adt::line_index::iterator adt::line_index::end() const {
+    return iterator();
+}
+
+#endif
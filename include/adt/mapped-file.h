@@ -0,0 +1,79 @@
+/**
+ * File: mapped-file.h
+ * ---------------------------
+ * Exports class mapped_file, a read-only memory mapping of a whole file,
+ * whose contents are seen as a string_ref: every string_ref search and split
+ * runs on the file with no copy, the kernel paging the data in on demand.
+ * The mapping is owned (RAII): it is unmapped by close() or the destructor,
+ * which invalidates the string_refs into it. POSIX (mmap) only.
+ */
+
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include "adt/string-ref.h"
+
+namespace adt {
+    /* Read-only view of a file's contents */
+    class mapped_file;
+}
+
+class adt::mapped_file {
+public:
+    /* Access pattern hints, or'ed together; they never make open() fail */
+    enum advice_t {
+        normal = 0,
+        sequential = 1,  /* MADV_SEQUENTIAL: aggressive read-ahead */
+        random = 2,      /* MADV_RANDOM: no read-ahead */
+        willneed = 4,    /* MADV_WILLNEED: start reading it all in now */
+        huge_pages = 8   /* MADV_HUGEPAGE: back with huge pages if the
+                            kernel can for this file system */
+    };
+
+    /**
+     * Constructors.
+     * Usage: adt::mapped_file log("app.log", adt::mapped_file::sequential);
+     *        if (!log.is_open()) { perror("app.log"); }
+     *        size_t lines = log.view().count_char('\n');
+     * ---------------------------
+     * Maps the file at path, as open() does. The default one maps nothing.
+     */
+    mapped_file() : ps(nullptr), len(0), mapped(false), err(0) {}
+    explicit mapped_file(string_ref path, unsigned advice = normal)
+    : mapped_file() { open(path, advice); }
+    ~mapped_file() { close(); }
+    /* the mapping can be moved, but not copied */
+    mapped_file(const mapped_file &) = delete;
+    mapped_file &operator=(const mapped_file &) = delete;
+    mapped_file(mapped_file &&other);
+    mapped_file &operator=(mapped_file &&other);
+
+    /* Unmaps the current file if any, then maps the file at path. Returns
+     * true on success; otherwise is_open() is false and error() tells the
+     * errno. An empty file maps to an empty view. */
+    bool open(string_ref path, unsigned advice = normal);
+
+    /* Unmaps the file, invalidating the string_refs into it */
+    void close();
+
+    /* Gives the kernel new access pattern hints, for the whole file; normal
+     * drops the read-ahead hints given before */
+    void advise(unsigned advice);
+
+    bool is_open() const { return ps != nullptr; }
+    /* errno of the last failed open(), 0 after a successful one */
+    int error() const { return err; }
+
+    /* The file's contents; NOTE no '\0' follows them */
+    string_ref view() const { return string_ref(ps, len); }
+    const char *data() const { return ps; }
+    size_t size() const { return len; }
+
+private:
+    const char *ps;  /* NULL if not open, "" for an empty file */
+    size_t len;
+    bool mapped;     /* false for an empty file, which is not mmap'ed */
+    int err;
+};
+
+#endif
@@ -0,0 +1,116 @@
+/**
+ * File: multi-pattern-matcher.h
+ * ---------------------------
+ * Exports class multi_pattern_matcher, an Aho-Corasick automaton built from a
+ * set of patterns, which finds all occurrences of all patterns in a haystack
+ * in one pass. Use it instead of calling string_ref::contains() for every
+ * keyword in a loop.
+ */
+
+#ifndef MULTI_PATTERN_MATCHER_H
+#define MULTI_PATTERN_MATCHER_H
+
+#include "adt/string-ref.h"
+#include <cstdint>
+#include <vector>
+
+namespace adt {
+    /* Aho-Corasick automaton over string_ref */
+    class multi_pattern_matcher;
+}
+
+class adt::multi_pattern_matcher {
+public:
+    /* An occurrence: the pattern's index in the construction list, and the
+     * index of the occurrence's first character in the haystack */
+    struct match {
+        size_t id;
+        size_t offset;
+    };
+
+    /**
+     * Constructor.
+     * Usage: adt::multi_pattern_matcher m({ "GET", "POST" });
+     *        adt::multi_pattern_matcher m(keywords, false);
+     * ---------------------------
+     * Builds the automaton. The transition table is a dense matrix with one
+     * row per state and one column per byte class (the bytes that occur in
+     * no pattern share one class), so a step is a single table load. If
+     * case_sensitive is false, ASCII letters match regardless of their case.
+     * Empty patterns never match. The patterns are not referenced afterwards.
+     * Throws std::length_error if the table would have 2^31 entries or more
+     * (states times byte classes).
+     */
+    explicit multi_pattern_matcher(const std::vector<string_ref> &patterns,
+                                   bool case_sensitive = true);
+
+    /* Number of patterns, including the empty ones */
+    size_t size() const { return patternLens.size(); }
+
+    /* Number of automaton states, for memory estimates */
+    size_t state_count() const { return transitions.size() / numClasses; }
+
+    /**
+     * Method: scan()
+     * Usage: m.scan(line, [&](const adt::multi_pattern_matcher::match &mt) {
+     *            ...; return true; });
+     * ---------------------------
+     * Calls the callback with each occurrence, in the order of their last
+     * character (longer patterns first if several end at the same character).
+     * Scanning stops early once the callback returns false.
+     */
+    template <typename Callback>
+    void scan(string_ref haystack, Callback callback) const;
+
+    /* Returns all occurrences, in the order of scan() */
+    std::vector<match> find_all(string_ref haystack) const;
+
+    /* Checks if any pattern occurs, returns bool */
+    bool contains_any(string_ref haystack) const;
+
+private:
+    /* a transition holds the target row's offset in transitions, plus this
+     * flag if the target state reports at least one pattern */
+    static const uint32_t hasOutput = 0x80000000u;
+    static const uint32_t noState = (uint32_t)-1;
+
+    uint16_t classOf[256];             /* byte -> column */
+    uint32_t numClasses;
+    std::vector<uint32_t> transitions; /* row-major, states x classes */
+    std::vector<uint32_t> ownFirst;    /* per state: its own patterns are */
+    std::vector<uint32_t> ownIds;      /* ownIds[ownFirst[s], ownFirst[s+1]) */
+    std::vector<uint32_t> dictLink;    /* per state: nearest proper suffix
+                                        * state with own patterns, or noState */
+    std::vector<size_t> patternLens;
+
+    /* Reports the patterns of a state; false if the callback asked to stop */
+    template <typename Callback>
+    bool report(uint32_t state, size_t end, Callback &callback) const;
+};
+
+template <typename Callback>
+bool adt::multi_pattern_matcher::report(uint32_t state, size_t end,
+                                        Callback &callback) const {
+    if (ownFirst[state] == ownFirst[state + 1]) { state = dictLink[state]; }
+    for (; state != noState; state = dictLink[state]) {
+        for (uint32_t i = ownFirst[state], e = ownFirst[state + 1]; i != e; ++i) {
+            size_t id = ownIds[i];
+            if (!callback(match{ id, end - patternLens[id] })) { return false; }
+        }
+    }
+    return true;
+}
+
+template <typename Callback>
+void adt::multi_pattern_matcher::scan(string_ref haystack, Callback callback) const {
+    const uint32_t *table = transitions.data();
+    const unsigned char *s = reinterpret_cast<const unsigned char *>(haystack.ptr());
+    uint32_t row = 0;
+    for (size_t i = 0, n = haystack.size(); i != n; ++i) {
+        uint32_t next = table[row + classOf[s[i]]];
+        row = next & ~hasOutput;
+        if ((next & hasOutput) && !report(row / numClasses, i + 1, callback)) { return; }
+    }
+}
+
+#endif
@@ -0,0 +1,45 @@
+/**
+ * File: parallel-search.h
+ * ---------------------------
+ * Exports parallel versions of string_ref::count_char(), count_str() and
+ * find_str() for large texts (e.g. a mapped_file's view). The text is cut
+ * into cache-sized chunks, which the threads of a thread_pool search
+ * independently. A match that starts in a chunk belongs to that chunk, and
+ * the chunk's search reads past its end (pattern.size() - 1 bytes) to find
+ * it, so matches straddling two chunks are found exactly once. The results
+ * are always those of the serial calls.
+ */
+
+#ifndef PARALLEL_SEARCH_H
+#define PARALLEL_SEARCH_H
+
+#include "adt/string-ref.h"
+#include "adt/thread-pool.h"
+
+namespace adt {
+    /* Default chunk size: a chunk fits in a core's L2 cache */
+    static const size_t parallel_chunk_size = 256 * 1024;
+
+    /**
+     * Functions: parallel_count_char(), parallel_count_str(), parallel_find_str()
+     * Usage: adt::mapped_file log("app.log");
+     *        size_t errors = adt::parallel_count_str(log.view(), "ERROR");
+     * ---------------------------
+     * Return the same as text.count_char(c), text.count_str(pattern,
+     * overlapping) and text.find_str(pattern). Texts of one chunk or less are
+     * searched by the calling thread alone. For non-overlapping counts, a
+     * chunk is searched again (by the calling thread) in the rare case that a
+     * match counted in the chunk before it ends inside it.
+     */
+    size_t parallel_count_char(string_ref text, char c,
+                               thread_pool &pool = thread_pool::shared(),
+                               size_t chunk_size = parallel_chunk_size);
+    size_t parallel_count_str(string_ref text, string_ref pattern, bool overlapping = true,
+                              thread_pool &pool = thread_pool::shared(),
+                              size_t chunk_size = parallel_chunk_size);
+    size_t parallel_find_str(string_ref text, string_ref pattern,
+                             thread_pool &pool = thread_pool::shared(),
+                             size_t chunk_size = parallel_chunk_size);
+}
+
+#endif
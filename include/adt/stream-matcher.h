@@ -0,0 +1,101 @@
+/**
+ * File: stream-matcher.h
+ * ---------------------------
+ * Exports class stream_matcher, which searches a pattern in a stream fed
+ * chunk by chunk (e.g. successive reads of a socket or a file). It carries
+ * the partial match at the end of a chunk over to the next, as KMP's
+ * automaton state, so occurrences straddling chunks are found without
+ * concatenating the buffers, and reports their offsets from the start of the
+ * stream. Between partial matches it jumps from match to match with the
+ * vectorized search of string_ref_searcher.
+ */
+
+#ifndef STREAM_MATCHER_H
+#define STREAM_MATCHER_H
+
+#include "adt/string-ref.h"
+#include "adt/string-searcher.h"
+#include <memory>
+#include <vector>
+
+namespace adt {
+    /* Pattern search over a chunked stream */
+    class stream_matcher;
+}
+
+class adt::stream_matcher {
+public:
+    static const size_t npos = string_ref::npos;
+
+    /**
+     * Constructor.
+     * Usage: adt::stream_matcher m("\r\n\r\n");
+     *        while ((n = read(fd, buf, sizeof buf)) > 0) {
+     *            m.feed(adt::string_ref(buf, n), [&](size_t offset) {
+     *                ...; return true; });
+     *        }
+     * ---------------------------
+     * Copies the pattern. Occurrences might overlap unless overlapping is
+     * false (then the search resumes after each occurrence, as in
+     * string_ref::count_str()). An empty pattern never matches.
+     */
+    explicit stream_matcher(string_ref pattern, bool overlapping = true);
+
+    string_ref pattern() const { return searcher.pattern(); }
+
+    /**
+     * Method: feed()
+     * Usage: size_t used = m.feed(chunk, [&](size_t offset) { ...; return true; });
+     *        std::vector<size_t> offsets = m.feed(chunk);
+     * ---------------------------
+     * Consumes the next chunk of the stream and calls the callback with the
+     * stream offset of each occurrence that ends in it, in order. If the
+     * callback returns false, feed() stops right after that occurrence and
+     * returns the number of the chunk's bytes consumed, so the rest can be
+     * fed later; otherwise it returns chunk.size(). The second form returns
+     * the offsets. The chunk is not referenced after feed() returns.
+     */
+    template <typename Callback>
+    size_t feed(string_ref chunk, Callback callback);
+    std::vector<size_t> feed(string_ref chunk);
+
+    /* Starts a new stream, at offset 0 */
+    void reset() { matched = 0; consumed = 0; }
+
+    /* Number of bytes consumed so far, i.e. the offset of the next byte */
+    size_t position() const { return consumed; }
+
+    /* Number of bytes at the end of what was consumed that match the start
+     * of the pattern: the stream must keep them to see an occurrence that
+     * the next chunk completes */
+    size_t pending() const { return matched; }
+
+private:
+    std::unique_ptr<char[]> chars;  /* the pattern; the searcher refers to it */
+    string_ref_searcher searcher;   /* also holds the KMP failure function */
+    bool overlapping;
+    size_t matched;                 /* KMP state: bytes of the pattern matched */
+    size_t consumed;
+
+    /* Scans chunk from i on for the next occurrence, and returns the index
+     * one past its end in chunk, else npos. Leaves i there (or at the end)
+     * and matched the state at i. */
+    size_t nextMatchEnd(string_ref chunk, size_t &i);
+};
+
+template <typename Callback>
+size_t adt::stream_matcher::feed(string_ref chunk, Callback callback) {
+    const size_t m = pattern().size();
+    const size_t base = consumed;
+    size_t i = 0, end;
+    while ((end = nextMatchEnd(chunk, i)) != npos) {
+        if (!callback(base + end - m)) {
+            consumed = base + end;
+            return end;
+        }
+    }
+    consumed = base + chunk.size();
+    return chunk.size();
+}
+
+#endif
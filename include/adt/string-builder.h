@@ -0,0 +1,84 @@
+/**
+ * File: string-builder.h
+ * ---------------------------
+ * Exports class string_builder, which builds strings piece by piece in an
+ * arena and hands them out as string_refs. A string grows in place at the
+ * arena's bump pointer while it is the arena's latest allocation, so
+ * building many small strings costs a few pointer bumps, not a malloc each.
+ * The strings stay valid as long as the arena does (until its reset()).
+ */
+
+#ifndef STRING_BUILDER_H
+#define STRING_BUILDER_H
+
+#include "adt/string-ref.h"
+#include "adt/arena.h"
+#include <cstdint>
+
+namespace adt {
+    /* Builds strings in an arena */
+    class string_builder;
+}
+
+class adt::string_builder {
+public:
+    /**
+     * Constructor.
+     * Usage: adt::arena a; adt::string_builder sb(a);
+     *        adt::string_ref s = sb.append("id=").append_int(42).finish();
+     * ---------------------------
+     * The builder borrows the arena, which must outlive the strings built.
+     */
+    explicit string_builder(arena &a) : pool(a), data(nullptr), len(0), cap(0) {}
+    string_builder(const string_builder &) = delete;
+    string_builder &operator=(const string_builder &) = delete;
+
+    /* Appends characters, returns *this for chaining */
+    string_builder &append(string_ref s) {
+        if (s.size() > cap - len) { grow(s.size()); }
+        if (!s.empty()) { std::memcpy(data + len, s.ptr(), s.size()); }
+        len += s.size();
+        return *this;
+    }
+    string_builder &append(char c) {
+        if (len == cap) { grow(1); }
+        data[len++] = c;
+        return *this;
+    }
+
+    /* Appends the decimal representation of an integer */
+    string_builder &append_int(long long value);
+    string_builder &append_int(unsigned long long value);
+    string_builder &append_int(int value) { return append_int((long long)value); }
+    string_builder &append_int(long value) { return append_int((long long)value); }
+    string_builder &append_int(unsigned value) {
+        return append_int((unsigned long long)value);
+    }
+    string_builder &append_int(unsigned long value) {
+        return append_int((unsigned long long)value);
+    }
+
+    /* Makes room for n more characters without further allocation */
+    void reserve(size_t n) {
+        if (n > cap - len) { grow(n); }
+    }
+
+    /* The string built so far (not null-terminated yet) */
+    string_ref view() const { return string_ref(data, len); }
+    size_t size() const { return len; }
+    bool empty() const { return len == 0; }
+
+    /* Returns the string built, null-terminated, and starts a new one. The
+     * unused room is given back to the arena. */
+    string_ref finish();
+
+private:
+    arena &pool;
+    char *data;   /* in the arena */
+    size_t len;
+    size_t cap;
+
+    void grow(size_t extra);
+};
+
+#endif
@@ -0,0 +1,90 @@
+/**
+ * File: string-interner.h
+ * ---------------------------
+ * Exports class string_interner, a pool that keeps one copy of each distinct
+ * string: interning a string_ref returns a stable string_ref to the pool's
+ * copy and a dense 32-bit id (0, 1, 2, ... in order of first appearance), so
+ * interned strings are equal iff their pointers (or ids) are. The copies live
+ * in an arena; the table is open-addressing with linear probing, and caches
+ * each string's hash and length next to its id.
+ */
+
+#ifndef STRING_INTERNER_H
+#define STRING_INTERNER_H
+
+#include "adt/string-ref.h"
+#include "adt/arena.h"
+#include <cstdint>
+#include <vector>
+
+namespace adt {
+    /* Deduplicating string pool, not thread-safe */
+    class string_interner;
+}
+
+class adt::string_interner {
+public:
+    /* id of no string, returned by find_id() if the string is not interned */
+    static const uint32_t invalid_id = UINT32_MAX;
+
+    /* Memory use and deduplication statistics, see stats() */
+    struct statistics {
+        size_t strings;          /* distinct strings, i.e. size() */
+        size_t interns;          /* calls to intern() and intern_id() */
+        size_t unique_bytes;     /* characters stored, '\0's not counted */
+        size_t duplicate_bytes;  /* characters of the interns that were hits */
+        size_t arena_bytes;      /* bytes reserved by the arena */
+        size_t table_bytes;      /* bytes of the hash table and the id index */
+    };
+
+    /* Creates an empty pool; expected_strings presizes the table */
+    explicit string_interner(size_t expected_strings = 0);
+    /* the pool owns the characters its string_refs point to */
+    string_interner(const string_interner &) = delete;
+    string_interner &operator=(const string_interner &) = delete;
+
+    /**
+     * Methods: intern(), intern_id()
+     * Usage: adt::string_ref name = pool.intern(header.first);
+     *        uint32_t id = pool.intern_id(tag);
+     * ---------------------------
+     * Returns the pool's copy of s (or its id), copying s into the pool first
+     * if it is not there yet. The copy is null-terminated and stays valid as
+     * long as the pool does. Throws std::length_error if s has UINT32_MAX
+     * characters or more, or if it would be string number UINT32_MAX.
+     */
+    string_ref intern(string_ref s) { return strings[intern_id(s)]; }
+    uint32_t intern_id(string_ref s);
+
+    /* Returns the id of s if it is interned, else invalid_id; never inserts */
+    uint32_t find_id(string_ref s) const;
+
+    /* Returns the string with the given id, which must be < size() */
+    string_ref operator[](uint32_t id) const {
+        assert(id < strings.size() && "Out of range: invalid string id.");
+        return strings[id];
+    }
+
+    /* Number of distinct strings interned */
+    size_t size() const { return strings.size(); }
+
+    statistics stats() const;
+
+private:
+    /* An empty slot has len == UINT32_MAX. The hash and length are compared
+     * before the characters, so a probe rarely touches the strings. */
+    struct slot {
+        uint64_t hash;
+        uint32_t len;
+        uint32_t id;
+    };
+    std::vector<slot> table;           /* power-of-2 size */
+    std::vector<string_ref> strings;   /* by id */
+    arena pool;
+    size_t interns, duplicateBytes;
+
+    size_t probe(string_ref s, uint64_t hash) const;
+    void grow();
+};
+
+#endif
@@ -16,18 +16,59 @@
 #include <algorithm>  /* std::min(), std::max() */
 #include <functional> /* std::hash<>, std::function<> */
 #include <iostream>   /* std::ostream */
+#include <iterator>   /* std::forward_iterator_tag */
+#include <cstdint>
+#include "adt/hash-bytes.h"
+#include "adt/compiler.h"
 
 namespace adt {
     /* Stack-allocated string, useful for short strings */
     class string_ref;
 
+    /* Precomputed set of characters, see string_ref::find_first_of() */
+    class char_set;
+
+    /* Lazy range of the tokens of a string_ref, see string_ref::split_all() */
+    class split_view;
+
+    /* Lazy range of the lines of a string_ref, see string_ref::lines() */
+    class line_view;
+
+    /* Converts ASCII letters to lower (upper) case in place, the len chars
+     * from s on; no null terminator needed. Other chars are left as they are.
+     * Vectorized. See also the overloads writing to another buffer, below. */
+    void ascii_tolower(char *s, size_t len);
+    void ascii_toupper(char *s, size_t len);
+
     /* Converts to lower case. ctype.h's tolower() only works with a single 
      * character. Note that the C-string must be mutable (NOT const char *) and
      * null-terminated. */
     inline void cstr_tolower(char *pstr) {
-        for (char *p = pstr; *p; ++p) { 
-            *p = (*p >= 'A' && *p <= 'Z') ? (*p | 0x60) : *p;
-        }
+        ascii_tolower(pstr, std::strlen(pstr));
+    }
+
+    /* ASCII character classes, usable as predicates wherever string_ref takes
+     * one, e.g. sr.find_if(adt::char_class::space). string_ref scans them with
+     * vectorized kernels instead of calling the predicate per character. */
+    namespace char_class {
+        template <int Id>
+        struct class_t {
+            bool operator()(char c) const {
+                unsigned char u = c;
+                switch (Id) {
+                case 0: return u == ' ' || (unsigned char)(u - '\t') < 5;
+                case 1: return (unsigned char)(u - '0') < 10;
+                default: return (unsigned char)(u - '0') < 10
+                                || (unsigned char)((u | 0x20) - 'a') < 26;
+                }
+            }
+        };
+        typedef class_t<0> space_t;   /* ' ', '\t', '\n', '\v', '\f', '\r' */
+        typedef class_t<1> digit_t;   /* '0' to '9' */
+        typedef class_t<2> alnum_t;   /* '0' to '9', 'A' to 'Z', 'a' to 'z' */
+        constexpr space_t space{};
+        constexpr digit_t digit{};
+        constexpr alnum_t alnum{};
     }
 }
 
@@ -45,10 +86,47 @@ public:
      * Functor for hashing, needed in templates like std::unordered_map<>.
      * Usage: size_t hashval = adt::string_ref::Hash{}(s);
      *        std::unordered_map<adt::string_ref, Value, adt::string_ref::Hash> m;
+     * It hashes the characters in place (see hash-bytes.h), no allocation.
+     * std::hash<adt::string_ref> is the same, so the third template argument
+     * can be omitted.
      */
     struct Hash {
-        size_t operator()(const string_ref s) const {
-            return std::hash<std::string>{}(std::string(s.ptr(), s.size()));
+        constexpr size_t operator()(const string_ref s) const {
+            return (size_t)hash_bytes(s.ptr(), s.size());
+        }
+    };
+
+    /**
+     * Functor for seeded hashing, e.g. for sharding across processes.
+     * Usage: uint64_t shard = adt::string_ref::SeededHash{seed}(s) % numShards;
+     * ---------------------------
+     * For a given seed, the value only depends on the characters: it is the
+     * same across processes, builds and platforms.
+     */
+    struct SeededHash {
+        uint64_t seed;
+        constexpr uint64_t operator()(const string_ref s) const {
+            return hash_bytes(s.ptr(), s.size(), seed);
+        }
+    };
+
+    /**
+     * Functors for case-insensitive hash maps, where ASCII letters are the
+     * same in either case.
+     * Usage: std::unordered_map<adt::string_ref, Value,
+     *            adt::string_ref::HashInsensitive,
+     *            adt::string_ref::EqualInsensitive> m;
+     * ---------------------------
+     * The case is folded on the fly, so no lower-cased copies are needed.
+     */
+    struct HashInsensitive {
+        constexpr size_t operator()(const string_ref s) const {
+            return (size_t)hash_bytes_insensitive(s.ptr(), s.size());
+        }
+    };
+    struct EqualInsensitive {
+        bool operator()(const string_ref lhs, const string_ref rhs) const {
+            return lhs.equals_insensitive(rhs);
         }
     };
 
@@ -64,12 +142,18 @@ public:
      * When the pointer is unkown (may be NULL), make the string_ref to be
      * empty (on memory, it's just a [\0]) with withNullAsEmpty() when the
      * pointer is NULL.
+     * The constructors from pointers are constexpr, as are the observers,
+     * comparisons, find() and the hash functors, so keyword tables can be
+     * built and checked at compile time:
+     *     constexpr adt::string_ref get = "GET"_sr;  // adt::literals
+     *     static_assert(get.size() == 3 && get.starts_with("GE"), "");
+     *     constexpr size_t h = adt::string_ref::Hash{}("Host");
      */
     /* Default, returns an empty reference, points to NULL */
-    string_ref() : ps(nullptr), len(0) {}
+    constexpr string_ref() : ps(nullptr), len(0) {}
     /* Accepts a const char *, e.g. a character or C-string literal */
-    string_ref(const char *str) : ps(str), len(str ? std::strlen(str) : 0) {}
-    string_ref(const char *str, size_t len) : ps(str), len(len) {}
+    constexpr string_ref(const char *str) : ps(str), len(str ? cstrLength(str) : 0) {}
+    constexpr string_ref(const char *str, size_t len) : ps(str), len(len) {}
     /* Accepts a std::string instance, allowing std::string to be passed to
      * an argument that is of type string_ref. NOTE this string_ref's lifetime
      * should be no longer than that std::string, or s.c_str() is invalidated */
@@ -78,7 +162,7 @@ public:
     : ps(s.c_str()), len(n < s.size() ? n : s.size()) {}
     /* Static method. Accepts a pointer (but unsure if it is not NULL).
      * Usage: string_ref sr = adt::string_ref::withNullAsEmpty(ptr); */
-    static string_ref withNullAsEmpty(const char *ptr) {
+    static constexpr string_ref withNullAsEmpty(const char *ptr) {
         return string_ref(ptr ? ptr : "");
     }
     /* copy constructor/assignment: shallow copy, like pointer */
@@ -96,28 +180,28 @@ public:
      * ---------------------------
      * The interface is just ike std::string.
      */
-    bool empty() const { return len == 0; }
+    constexpr bool empty() const { return len == 0; }
     /* Get the pointer. NOTE ps[len] is NOT guaranteed to be '\0' */
-    const char *ptr() const { return ps; }   /* std::string s(sr.ptr()); */
+    constexpr const char *ptr() const { return ps; }   /* std::string s(sr.ptr()); */
     /* Convert to a std::string object. NOTE it makes a deep copy. */
     std::string to_string() const { return std::string(ps, len); }
     /* two equivalent methods, for readability in different contexts */
-    size_t length() const { return len; }   /* trailing '\0' not counted */
-    size_t size() const { return len; }     /* trailing '\0' not counted */
+    constexpr size_t length() const { return len; }   /* trailing '\0' not counted */
+    constexpr size_t size() const { return len; }     /* trailing '\0' not counted */
     /* iterators: iterators are equivalent to constant iterators */
-    iterator begin() const { return ps; }
-    iterator cbegin() const { return ps; }
-    iterator end() const { return ps + len; }
-    iterator cend() const { return ps + len; }
-    char front() const {
+    constexpr iterator begin() const { return ps; }
+    constexpr iterator cbegin() const { return ps; }
+    constexpr iterator end() const { return ps + len; }
+    constexpr iterator cend() const { return ps + len; }
+    constexpr char front() const {
         assert(!empty() && "front() was called on an empty instance.");
         return ps[0];
     }
-    char back() const {
+    constexpr char back() const {
         assert(!empty() && "back() was called on an empty instance.");
         return ps[len-1];
     }
-    bool equals(string_ref rhs) const {
+    constexpr bool equals(string_ref rhs) const {
         return len == rhs.len && memCompare(ps, rhs.ps, len) == 0;
     }
     
@@ -128,7 +212,7 @@ public:
      * Returns 0 if match; -1 if lhs is lexicographically lower; 1 otherwise.
      * NOTE that ps[len] is NOT guatanteed to be '\0'.
      */
-    int compare(string_ref rhs) const {
+    constexpr int compare(string_ref rhs) const {
         int comp = memCompare(ps, rhs.ps, std::min(len, rhs.len));
         if (comp != 0) { return comp < 0 ? -1 : 1; }
         if (len == rhs.len) { return 0; }
@@ -141,7 +225,7 @@ public:
      * ---------------------------
      * Returns the character on the given position.
      */
-    char operator[](size_t pos) const {
+    constexpr char operator[](size_t pos) const {
         assert(pos < len && "Out of range: invalid index on the string.");
         return ps[pos];
     }
@@ -154,26 +238,66 @@ public:
      * function object class, or a function object.
      */
     /* Checks if it starts with a prefix, returns bool */
-    bool starts_with(string_ref prefix) const;
+    constexpr bool starts_with(string_ref prefix) const {
+        return prefix.len <= len && memCompare(ps, prefix.ps, prefix.len) == 0;
+    }
 
     /* Checks if it ends with a suffix, returns bool */
-    bool ends_with(string_ref suffix) const;
+    constexpr bool ends_with(string_ref suffix) const {
+        return suffix.len <= len
+               && memCompare(ps + (len - suffix.len), suffix.ps, suffix.len) == 0;
+    }
+
+    /**
+     * Methods: equals_insensitive(), compare_insensitive(),
+     *          starts_with_insensitive(), ends_with_insensitive(),
+     *          find_insensitive()
+     * Usage: if (header.starts_with_insensitive("content-")) { ... }
+     * ---------------------------
+     * The same as equals(), compare(), starts_with(), ends_with() and
+     * find_str(), but ASCII letters compare regardless of their case, as if
+     * both sides were lower-cased (so compare_insensitive() orders "_" before
+     * "a" and "A"). The case is folded a vector at a time while comparing,
+     * with no copy. find_insensitive() searches from start, and returns start
+     * if the pattern is empty and start is at most size().
+     */
+    bool equals_insensitive(string_ref rhs) const;
+    int compare_insensitive(string_ref rhs) const;
+    bool starts_with_insensitive(string_ref prefix) const;
+    bool ends_with_insensitive(string_ref suffix) const;
+    size_t find_insensitive(string_ref pattern, size_t start = 0) const;
 
     /* Checks if it contains a character, returns bool */
-    bool contains(char c) const {
+    ADT_CONSTEXPR bool contains(char c) const {
         return find(c) != npos;
     }
     
     /* Checks if it contains a substring that matches a pattern, returns bool */
-    bool contains(string_ref pattern) const {
-        return find_str(pattern) != npos;
+    ADT_CONSTEXPR bool contains(string_ref pattern) const {
+        return find(pattern) != npos;
     }
 
-    /* Returns edit distance (Levenshtein distance) */
+    /* Returns edit distance (Levenshtein distance). If not case_sensitive,
+     * ASCII letters are compared regardless of their case. Bit-parallel,
+     * no heap allocation if the shorter string has at most 64 characters */
     size_t edit_distance(const string_ref rhs, bool case_sensitive = true) const;
 
-    /* Searches for a character, returns index if found, else npos. */
-    size_t find(char c, size_t start = 0) const { 
+    /* Checks if edit distance is at most max_k, returns bool. Faster than
+     * edit_distance() for a small max_k: it only looks at the strings' parts
+     * that can be within max_k edits, and gives up early */
+    bool edit_distance_within(const string_ref rhs, size_t max_k,
+                              bool case_sensitive = true) const;
+
+    /* Searches for a character, returns index if found, else npos.
+     * find() is constexpr where compiler.h allows it (ADT_CONSTEXPR): in a
+     * constant expression it is a simple loop. */
+    ADT_CONSTEXPR size_t find(char c, size_t start = 0) const {
+        if (ADT_IS_CONSTANT_EVALUATED()) {
+            for (size_t i = start; i < len; ++i) {
+                if (ps[i] == c) { return i; }
+            }
+            return npos;
+        }
         return find_char(c, start);
     }
     size_t find_char(char c, size_t start = 0) const;
@@ -187,47 +311,99 @@ public:
     /* Searches for a substring (needle) that matches a pattern, returns the 
      * first index of that substring if found in *this (haystack) else npos.
      * Return 0 if pattern is empty, i.e. *(pattern.ps) == '\0' */
-    size_t find(string_ref pattern) const {
+    ADT_CONSTEXPR size_t find(string_ref pattern) const {
+        if (ADT_IS_CONSTANT_EVALUATED()) {
+            for (size_t i = 0; i + pattern.len <= len; ++i) {
+                if (memCompare(ps + i, pattern.ps, pattern.len) == 0) { return i; }
+            }
+            return npos;
+        }
         return find_str(pattern);
     }
     size_t find_str(string_ref pattern) const;
 
     /* Searches for a substring (needle) that matches a pattern reversely, returns the 
-     * first index of that substring if found in *this (haystack), else npos */
+     * first index of that substring if found in *this (haystack), else npos.
+     * Return 0 if pattern is empty */
     size_t rfind(string_ref pattern) const {
         return rfind_str(pattern);
     }
     size_t rfind_str(string_ref pattern) const;
 
+    /* NOTE the template overloads of the predicate searches below take any
+     * callable (lambda, function pointer, function object) and inline it,
+     * while the std::function overloads make an indirect call per character.
+     * The adt::char_class predicates are vectorized. */
+
     /* Searches with a predicate (can be a lambda), returns the first index 
      * that is found to be true, else npos */
     size_t find_if(std::function<bool(char)> pred, size_t start = 0) const;
+    template <typename Pred>
+    size_t find_if(Pred pred, size_t start = 0) const {
+        return findIf(pred, start, false);
+    }
 
     /* Searches with a predicate (can be a lambda), returns the first index
      * that is found to be false, else npos */
     size_t find_if_not(std::function<bool(char)> pred, size_t start = 0) const {
-        return find_if([pred](char c){ return !pred(c); }, start);
+        return findIf(pred, start, true);
+    }
+    template <typename Pred>
+    size_t find_if_not(Pred pred, size_t start = 0) const {
+        return findIf(pred, start, true);
     }
 
     /* Searches reversely with a predicate (can be a lambda), returns the first 
      * index that is found to be true, else npos */
     size_t rfind_if(std::function<bool(char)> pred, size_t rstart = npos) const;
+    template <typename Pred>
+    size_t rfind_if(Pred pred, size_t rstart = npos) const {
+        return rfindIf(pred, rstart, false);
+    }
 
     /* Searches reversely with a predicate (can be a lambda), returns the first
      * index that is found to be false, else npos */
     size_t rfind_if_not(std::function<bool(char)> pred, size_t rstart = npos) const {
-        return rfind_if([pred](char c){ return !pred(c); }, rstart);
+        return rfindIf(pred, rstart, true);
     }
+    template <typename Pred>
+    size_t rfind_if_not(Pred pred, size_t rstart = npos) const {
+        return rfindIf(pred, rstart, true);
+    }
+
+    /**
+     * Methods: find_first_of(), find_first_not_of(), find_last_of(),
+     *          find_last_not_of()
+     * Usage: size_t pos = sr.find_first_of(" \t\n");
+     *        adt::char_set delims(",;"); pos = sr.find_last_of(delims, pos);
+     * ---------------------------
+     * Searches for the first (last) character that is (not) one of the chars,
+     * like std::string's methods of the same names: returns its index, or
+     * npos if there is none. The first two search [start, len), and the last
+     * two [0, rstart]. The chars are turned into a char_set, and the string
+     * is scanned with a table lookup a vector at a time, whatever the number
+     * of chars; pass a char_set to build it only once for many searches.
+     */
+    size_t find_first_of(string_ref chars, size_t start = 0) const;
+    size_t find_first_of(const char_set &chars, size_t start = 0) const;
+    size_t find_first_not_of(string_ref chars, size_t start = 0) const;
+    size_t find_first_not_of(const char_set &chars, size_t start = 0) const;
+    size_t find_last_of(string_ref chars, size_t rstart = npos) const;
+    size_t find_last_of(const char_set &chars, size_t rstart = npos) const;
+    size_t find_last_not_of(string_ref chars, size_t rstart = npos) const;
+    size_t find_last_not_of(const char_set &chars, size_t rstart = npos) const;
 
     /* Counts occurrence of a character, returns size_t */
     size_t count_char(char c) const;
 
-    /* Counts occurrence of a pattern (might overlaps), returns size_t */
-    size_t count_str(string_ref pattern) const;
+    /* Counts occurrence of a pattern, returns size_t. Occurrences might
+     * overlap (e.g. "aa" occurs 3 times in "aaaa") unless overlapping is false
+     * (then "aa" occurs twice in "aaaa"). Linear time in size() + pattern.size() */
+    size_t count_str(string_ref pattern, bool overlapping = true) const;
 
     /* Shallow-copies a string_ref, but only keeps the element between the
      * range [start, start + num) INTERSECT [0, len). */
-    string_ref substr(size_t start, size_t num = capacity) const {
+    constexpr string_ref substr(size_t start, size_t num = capacity) const {
         start = std::min(start, len);
         return string_ref(ps + start, std::min(num, len - start));
     }
@@ -242,29 +418,33 @@ public:
     }
     
     /* Shallow-copies a string_ref, but only keeps the first AT MOST n elements */
-    string_ref take_front(size_t n = 1) const {
+    constexpr string_ref take_front(size_t n = 1) const {
         return string_ref(ps, std::min(n, len));
     }
 
     /* Shallow-copies a string_ref, but only keeps the first consecutive elements
      * that are all found to be true */
     string_ref take_front_while(std::function<bool(char)> pred) const {
-        return substr(0, find_if_not(pred));
+        return substr(0, findIf(pred, 0, true));
+    }
+    template <typename Pred>
+    string_ref take_front_while(Pred pred) const {
+        return substr(0, findIf(pred, 0, true));
     }
 
     /* Shallow-copies a string_ref, but only keeps the last AT MOST n elements */
-    string_ref take_back(size_t n = 1) const {
+    constexpr string_ref take_back(size_t n = 1) const {
         return (n <= len) ? drop_front(len - n) : *this;
     }
 
     /* Shallow-copies a string_ref, but drops the first EXACTLY n elements */
-    string_ref drop_front(size_t n = 1) const {
+    constexpr string_ref drop_front(size_t n = 1) const {
         assert(n <= len && "Dropping more characters than exist.");
         return substr(n);
     }
 
     /* Shallow-copies a string_ref, but drops the last EXACTLY n elements */
-    string_ref drop_back(size_t n = 1) const {
+    constexpr string_ref drop_back(size_t n = 1) const {
         assert(n <= len && "Dropping more characters than exist.");
         return substr(0, len - n);
     }
@@ -280,51 +460,403 @@ public:
     std::pair<string_ref, string_ref> rsplit(char sep) const;
     std::pair<string_ref, string_ref> rsplit(string_ref sep) const;
 
+    /**
+     * Methods: split_all(), split_any_of()
+     * Usage: for (adt::string_ref field : line.split_all(',')) { ... }
+     *        for (auto word : text.split_any_of(" \t\n", npos, true)) { ... }
+     * ---------------------------
+     * Returns a lazy forward range of the tokens between the separators: a
+     * char, a string, or any char of a set (split_any_of). Tokens are found
+     * one at a time while iterating, with no allocation. At most max_splits
+     * separators are split on, the rest of the string being the last token.
+     * If skip_empty, empty tokens are skipped (and do not count as splits);
+     * otherwise n separators always make n + 1 tokens. An empty string
+     * separator never matches.
+     */
+    split_view split_all(char sep, size_t max_splits = npos,
+                         bool skip_empty = false) const;
+    split_view split_all(string_ref sep, size_t max_splits = npos,
+                         bool skip_empty = false) const;
+    split_view split_any_of(string_ref seps, size_t max_splits = npos,
+                            bool skip_empty = false) const;
+
+    /**
+     * Method: lines()
+     * Usage: for (adt::string_ref line : text.lines()) { ... }
+     * ---------------------------
+     * Returns a lazy forward range of the lines, i.e. of the tokens between
+     * '\n's, found with the vectorized character search. A line does not
+     * include its "\n" or "\r\n". A final '\n' ends the last line rather
+     * than starting an empty one, so "a\nb\n" and "a\nb" both have 2 lines,
+     * and an empty string has none. See also adt::line_index, which finds
+     * all the newlines of a large text in one pass.
+     */
+    line_view lines() const;
+
 private:
     const char *ps;   /* 1-word size */
     size_t len;       /* 1-word size, trailing '\0' NOT counted */
-    static int memCompare(const char *lhs, const char *rhs, size_t len) {
+    static constexpr int memCompare(const char *lhs, const char *rhs, size_t len) {
+        if (ADT_IS_CONSTANT_EVALUATED()) {
+            for (size_t i = 0; i != len; ++i) {
+                if (lhs[i] != rhs[i]) {
+                    return (unsigned char)lhs[i] < (unsigned char)rhs[i] ? -1 : 1;
+                }
+            }
+            return 0;
+        }
         if (len == 0) { return 0; } /* here memcmp(lhs,rhs,len) undefined. */
         return std::memcmp(lhs, rhs, len);
     }
+    static constexpr size_t cstrLength(const char *str) {
+        if (ADT_IS_CONSTANT_EVALUATED()) {
+            size_t n = 0;
+            while (str[n] != '\0') { ++n; }
+            return n;
+        }
+        return std::strlen(str);
+    }
+    /* The loops behind the predicate searches, looking for the first or last
+     * character whose predicate value differs from negate. The overloads for
+     * adt::char_class are more specialized, so they win over the generic ones
+     * and go to the vectorized kernels. */
+    template <typename Pred>
+    size_t findIf(const Pred &pred, size_t start, bool negate) const {
+        for (size_t i = start; i < len; ++i) {
+            if (bool(pred(ps[i])) != negate) { return i; }
+        }
+        return npos;
+    }
+    template <typename Pred>
+    size_t rfindIf(const Pred &pred, size_t rstart, bool negate) const {
+        if (len == 0) { return npos; }
+        for (size_t i = std::min(rstart, len - 1) + 1; i != 0; --i) {
+            if (bool(pred(ps[i - 1])) != negate) { return i - 1; }
+        }
+        return npos;
+    }
+    template <int Id>
+    size_t findIf(const char_class::class_t<Id> &, size_t start, bool negate) const {
+        return findClass(Id, start, negate);
+    }
+    template <int Id>
+    size_t rfindIf(const char_class::class_t<Id> &, size_t rstart, bool negate) const {
+        return rfindClass(Id, rstart, negate);
+    }
+    size_t findClass(int id, size_t start, bool negate) const;
+    size_t rfindClass(int id, size_t rstart, bool negate) const;
+    size_t findSet(const char_set &chars, size_t start, bool negate) const;
+    size_t rfindSet(const char_set &chars, size_t rstart, bool negate) const;
+};
+
+/**
+ * Class: char_set
+ * Usage: adt::char_set delims(" \t,;"); size_t pos = sr.find_first_of(delims);
+ * ---------------------------
+ * A set of characters (bytes), in the two forms the find_first_of() family
+ * needs: a 256-bit bitmap, and two 16-byte tables indexed by the low nibble
+ * of a byte, each holding the bits of the high nibbles that go with it
+ * (0-7 in the first table, 8-15 in the second).
+ */
+class adt::char_set {
+public:
+    char_set() {}
+    explicit char_set(string_ref chars) {
+        for (char c : chars) { insert(c); }
+    }
+    void insert(char c) {
+        unsigned char u = c;
+        bits[u / 64] |= (uint64_t)1 << (u % 64);
+        nibbles[16 * (u >> 7) + (u & 0x0f)] |= (unsigned char)(1 << ((u >> 4) & 7));
+    }
+    bool contains(char c) const {
+        unsigned char u = c;
+        return (bits[u / 64] >> (u % 64)) & 1;
+    }
+    /* The tables, for the scanning kernels */
+    const uint64_t *bitmap() const { return bits; }
+    const unsigned char *nibble_table() const { return nibbles; }
+
+private:
+    uint64_t bits[4] = { 0, 0, 0, 0 };
+    unsigned char nibbles[32] = {};
+};
+
+class adt::split_view {
+public:
+    class iterator;
+    typedef iterator const_iterator;
+
+    /* Prefer string_ref::split_all() and string_ref::split_any_of() */
+    split_view(string_ref str, char sep, size_t max_splits, bool skip_empty)
+    : str(str), kind(by_char), sepChar(sep), maxSplits(max_splits),
+      skipEmpty(skip_empty) {}
+    split_view(string_ref str, string_ref sep, size_t max_splits, bool skip_empty)
+    : str(str), kind(by_string), sepChar(0), sepStr(sep),
+      maxSplits(max_splits), skipEmpty(skip_empty) {}
+    static split_view any_of(string_ref str, string_ref seps, size_t max_splits,
+                             bool skip_empty) {
+        split_view view(str, '\0', max_splits, skip_empty);
+        view.kind = by_set;
+        view.sepSet = char_set(seps);
+        return view;
+    }
+
+    iterator begin() const;
+    iterator end() const;
+
+private:
+    enum kind_t { by_char, by_string, by_set };
+    string_ref str;
+    kind_t kind;
+    char sepChar;
+    string_ref sepStr;
+    char_set sepSet;   /* by_set only */
+    size_t maxSplits;
+    bool skipEmpty;
+
+    /* Returns the index of the first separator in s, and its length in
+     * sepLen, else string_ref::npos */
+    size_t findSep(string_ref s, size_t &sepLen) const {
+        switch (kind) {
+        case by_char:
+            sepLen = 1;
+            return s.find_char(sepChar);
+        case by_string:
+            sepLen = sepStr.size();
+            return sepStr.empty() ? string_ref::npos : s.find_str(sepStr);
+        default:
+            sepLen = 1;
+            return s.find_first_of(sepSet);
+        }
+    }
+};
+
+class adt::split_view::iterator {
+public:
+    typedef std::forward_iterator_tag iterator_category;
+    typedef string_ref value_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef const string_ref *pointer;
+    typedef const string_ref &reference;
+
+    iterator() : view(nullptr), splits(0), hasRest(false), atEnd(true) {}
+
+    reference operator*() const { return token; }
+    pointer operator->() const { return &token; }
+    iterator &operator++() { advance(); return *this; }
+    iterator operator++(int) { iterator old = *this; advance(); return old; }
+    /* tokens of the same range are told apart by their positions */
+    bool operator==(const iterator &rhs) const {
+        return atEnd == rhs.atEnd && (atEnd || token.ptr() == rhs.token.ptr());
+    }
+    bool operator!=(const iterator &rhs) const { return !(*this == rhs); }
+
+private:
+    friend class split_view;
+    const split_view *view;
+    string_ref token;  /* current token */
+    string_ref rest;   /* what follows the current token's separator */
+    size_t splits;     /* separators split on so far */
+    bool hasRest;      /* false once the current token is the last one */
+    bool atEnd;
+
+    explicit iterator(const split_view *view)
+    : view(view), rest(view->str), splits(0), hasRest(true), atEnd(false) {
+        advance();
+    }
+
+    void advance() {
+        while (hasRest) {
+            size_t sepLen = 0;
+            if (splits >= view->maxSplits && view->skipEmpty) {
+                /* the last token starts after the skipped separators */
+                while (view->findSep(rest, sepLen) == 0) { rest = rest.substr(sepLen); }
+            }
+            size_t pos = splits < view->maxSplits ? view->findSep(rest, sepLen)
+                                                  : string_ref::npos;
+            if (pos == string_ref::npos) {
+                token = rest;
+                hasRest = false;
+            } else {
+                token = rest.substr(0, pos);
+                rest = rest.substr(pos + sepLen);
+            }
+            if (!token.empty() || !view->skipEmpty) {
+                if (hasRest) { ++splits; }
+                return;
+            }
+        }
+        atEnd = true;
+    }
+};
+
+inline adt::split_view::iterator adt::split_view::begin() const {
+    return iterator(this);
+}
+
+inline adt::split_view::iterator adt::split_view::end() const {
+    return iterator();
+}
+
+inline adt::split_view adt::string_ref::split_all(char sep, size_t max_splits,
+                                                  bool skip_empty) const {
+    return split_view(*this, sep, max_splits, skip_empty);
+}
+
+inline adt::split_view adt::string_ref::split_all(string_ref sep, size_t max_splits,
+                                                  bool skip_empty) const {
+    return split_view(*this, sep, max_splits, skip_empty);
+}
+
+inline adt::split_view adt::string_ref::split_any_of(string_ref seps, size_t max_splits,
+                                                     bool skip_empty) const {
+    return split_view::any_of(*this, seps, max_splits, skip_empty);
+}
+
+class adt::line_view {
+public:
+    class iterator;
+    typedef iterator const_iterator;
+
+    /* Prefer string_ref::lines() */
+    explicit line_view(string_ref str) : str(str) {}
+
+    iterator begin() const;
+    iterator end() const;
+
+private:
+    string_ref str;
+};
+
+class adt::line_view::iterator {
+public:
+    typedef std::forward_iterator_tag iterator_category;
+    typedef string_ref value_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef const string_ref *pointer;
+    typedef const string_ref &reference;
+
+    iterator() : atEnd(true) {}
+
+    reference operator*() const { return line; }
+    pointer operator->() const { return &line; }
+    iterator &operator++() { advance(); return *this; }
+    iterator operator++(int) { iterator old = *this; advance(); return old; }
+    bool operator==(const iterator &rhs) const {
+        return atEnd == rhs.atEnd && (atEnd || line.ptr() == rhs.line.ptr());
+    }
+    bool operator!=(const iterator &rhs) const { return !(*this == rhs); }
+
+private:
+    friend class line_view;
+    string_ref line;  /* current line */
+    string_ref rest;  /* what follows the current line's '\n' */
+    bool atEnd;
+
+    explicit iterator(string_ref str) : rest(str), atEnd(false) { advance(); }
+
+    void advance() {
+        if (rest.empty()) {
+            atEnd = true;
+            return;
+        }
+        size_t pos = rest.find_char('\n');
+        if (pos == string_ref::npos) {
+            line = rest;
+            rest = rest.substr(rest.size());
+            return;
+        }
+        line = rest.substr(0, pos > 0 && rest[pos - 1] == '\r' ? pos - 1 : pos);
+        rest = rest.substr(pos + 1);
+    }
 };
 
+inline adt::line_view::iterator adt::line_view::begin() const {
+    return iterator(str);
+}
+
+inline adt::line_view::iterator adt::line_view::end() const {
+    return iterator();
+}
+
+inline adt::line_view adt::string_ref::lines() const {
+    return line_view(*this);
+}
+
 /* Operater overloading. No need to give the namespace qualifier when using
  * them, thanks to argument-dependent lookup (ADL) */
 namespace adt {
-    inline bool operator==(string_ref lhs, string_ref rhs) {
+    constexpr bool operator==(string_ref lhs, string_ref rhs) {
         return lhs.equals(rhs);
     }
-    inline bool operator!=(string_ref lhs, string_ref rhs) {
+    constexpr bool operator!=(string_ref lhs, string_ref rhs) {
         return !lhs.equals(rhs);
     }
-    inline bool operator<(string_ref lhs, string_ref rhs) {
+    constexpr bool operator<(string_ref lhs, string_ref rhs) {
         return lhs.compare(rhs) < 0;
     }
-    inline bool operator<=(string_ref lhs, string_ref rhs) {
+    constexpr bool operator<=(string_ref lhs, string_ref rhs) {
         return lhs.compare(rhs) <= 0;
     }
-    inline bool operator>(string_ref lhs, string_ref rhs) {
+    constexpr bool operator>(string_ref lhs, string_ref rhs) {
         return lhs.compare(rhs) > 0;
     }
-    inline bool operator>=(string_ref lhs, string_ref rhs) {
+    constexpr bool operator>=(string_ref lhs, string_ref rhs) {
         return lhs.compare(rhs) >= 0;
     }
-    inline std::string operator+(std::string stdstr, string_ref sr) {
-        std::string res = stdstr;
-        return res.append(sr.ptr(), sr.size());
+    /* the result is allocated once, at its final size; a temporary left
+     * operand is appended to and moved instead */
+    inline std::string operator+(const std::string &stdstr, string_ref sr) {
+        std::string res;
+        res.reserve(stdstr.size() + sr.size());
+        return res.append(stdstr).append(sr.ptr(), sr.size());
+    }
+    inline std::string operator+(std::string &&stdstr, string_ref sr) {
+        return std::move(stdstr.append(sr.ptr(), sr.size()));
     }
-    inline std::string operator+=(std::string stdstr, string_ref sr) {
+    /* appends to stdstr itself, like std::string's operator+=() */
+    inline std::string &operator+=(std::string &stdstr, string_ref sr) {
         return stdstr.append(sr.ptr(), sr.size());
     }
     inline std::ostream &operator<<(std::ostream &os, string_ref sr) {
         os << std::string(sr.ptr(), sr.size());
         return os;
     }
+    /* Writes src with its ASCII letters converted to lower (upper) case to
+     * dst, which must have room for src.size() chars; no null terminator is
+     * appended. dst may be src.ptr() (in place), but not overlap it otherwise.
+     * Usage: std::vector<char> buf(key.size()); adt::ascii_tolower(buf.data(), key); */
+    void ascii_tolower(char *dst, string_ref src);
+    void ascii_toupper(char *dst, string_ref src);
     inline size_t edit_distance(const string_ref lhs, const string_ref rhs,
                                 bool case_sensitive = true) {
         return lhs.edit_distance(rhs, case_sensitive);
     }
+    inline bool edit_distance_within(const string_ref lhs, const string_ref rhs,
+                                     size_t max_k, bool case_sensitive = true) {
+        return lhs.edit_distance_within(rhs, max_k, case_sensitive);
+    }
+
+    /* User-defined literal, usable in constant expressions; it also keeps
+     * any '\0' inside the literal.
+     * Usage: using namespace adt::literals;
+     *        constexpr adt::string_ref method = "GET"_sr; */
+    inline namespace literals {
+        constexpr string_ref operator"" _sr(const char *str, size_t len) {
+            return string_ref(str, len);
+        }
+    }
+}
+
+/* std::hash<> specialization, the same as adt::string_ref::Hash */
+namespace std {
+    template <>
+    struct hash<adt::string_ref> {
+        size_t operator()(const adt::string_ref s) const {
+            return adt::string_ref::Hash{}(s);
+        }
+    };
 }
 
 #endif
\ No newline at end of file
@@ -0,0 +1,89 @@
+/**
+ * File: string-searcher.h
+ * ---------------------------
+ * Exports class string_ref_searcher, a needle (pattern) preprocessed once and
+ * then searched for in any number of string_ref haystacks. Use it instead of
+ * string_ref::find_str() when the same needle is searched for many times.
+ * Like string_ref, it does not own the needle's characters.
+ */
+
+#ifndef STRING_SEARCHER_H
+#define STRING_SEARCHER_H
+
+#include "adt/string-ref.h"
+#include <cstdint>
+#include <vector>
+#include <utility>  /* std::pair<> */
+#include <iterator> /* std::distance() */
+
+namespace adt {
+    /* Preprocessed needle, reusable across haystacks */
+    class string_ref_searcher;
+    class stream_matcher;
+}
+
+class adt::string_ref_searcher {
+public:
+    static const size_t npos = string_ref::npos;
+
+    /**
+     * Constructor.
+     * Usage: adt::string_ref_searcher searcher("needle");
+     * ---------------------------
+     * Preprocesses the needle: picks its two rarest bytes for the vectorized
+     * candidate filter, or builds the Horspool shift tables for long needles,
+     * and the KMP failure function that keeps count() and find_all() linear.
+     * NOTE the needle's characters must outlive the searcher.
+     */
+    explicit string_ref_searcher(string_ref pattern);
+
+    string_ref pattern() const { return needle; }
+
+    /* Returns the index of the first occurrence at or after start, else npos.
+     * An empty needle is found at start (if start <= haystack.size()). */
+    size_t find(string_ref haystack, size_t start = 0) const;
+
+    /* Returns the index of the last occurrence starting at or before rstart,
+     * else npos. An empty needle is found at 0. */
+    size_t rfind(string_ref haystack, size_t rstart = npos) const;
+
+    /* Counts the occurrences, returns size_t. They might overlap unless
+     * overlapping is false, as in string_ref::count_str(). An empty needle
+     * occurs at every index in [0, haystack.size()] */
+    size_t count(string_ref haystack, bool overlapping = true) const;
+
+    /* Returns the indices of all occurrences in order, overlapping or not
+     * as in count() */
+    std::vector<size_t> find_all(string_ref haystack, bool overlapping = true) const;
+
+    /**
+     * Method: operator()(), overloading operator
+     * Usage: auto range = searcher(hay.begin(), hay.end());
+     * ---------------------------
+     * Searcher semantics of C++17's std::search(first, last, searcher):
+     * returns the range [match_first, match_last) of the first occurrence in
+     * [first, last), or {last, last} if not found. The iterators must refer
+     * to contiguous chars (e.g. string_ref's and std::string's iterators).
+     */
+    template <typename RandomIt>
+    std::pair<RandomIt, RandomIt> operator()(RandomIt first, RandomIt last) const {
+        if (first == last) {
+            return needle.empty() ? std::make_pair(first, first)
+                                  : std::make_pair(last, last);
+        }
+        size_t pos = find(string_ref(&*first, std::distance(first, last)));
+        if (pos == npos) { return std::make_pair(last, last); }
+        return std::make_pair(first + pos, first + pos + needle.size());
+    }
+
+private:
+    friend class stream_matcher;  /* resumes KMP across chunks with fail */
+    string_ref needle;
+    size_t rareA, rareB;  /* bytes compared by the vectorized filter */
+    uint32_t shift[256];  /* Horspool tables, only built for long needles
+                           * (zeroed otherwise, so copies read defined values) */
+    uint32_t rshift[256];
+    std::vector<size_t> fail;  /* KMP failure function, for count() and find_all() */
+};
+
+#endif
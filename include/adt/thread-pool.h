@@ -0,0 +1,81 @@
+/**
+ * File: thread-pool.h
+ * ---------------------------
+ * Exports class thread_pool, a fixed set of worker threads that run the
+ * iterations of a parallel loop. The iterations are split evenly between
+ * the threads up front. A thread that runs out steals the second half of
+ * what another thread has left (work stealing on index ranges). So uneven
+ * iterations (e.g. a search that stops early in some chunks) still keep
+ * every thread busy, and the scheduling costs one uncontended lock per
+ * iteration.
+ */
+
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace adt {
+    /* Worker threads for parallel loops */
+    class thread_pool;
+}
+
+class adt::thread_pool {
+public:
+    /* Creates num_threads - 1 worker threads: the thread calling
+     * parallel_for() works too. 0 means one per hardware thread. */
+    explicit thread_pool(size_t num_threads = 0);
+    ~thread_pool();
+    thread_pool(const thread_pool &) = delete;
+    thread_pool &operator=(const thread_pool &) = delete;
+
+    /* A process-wide pool of one thread per hardware thread, created on
+     * first use */
+    static thread_pool &shared();
+
+    /* Number of threads running the iterations, the caller included */
+    size_t size() const { return workers.size() + 1; }
+
+    /**
+     * Method: parallel_for()
+     * Usage: pool.parallel_for(chunks, [&](size_t i) { partial[i] = work(i); });
+     * ---------------------------
+     * Runs task(0), task(1), ..., task(count - 1) on the pool's threads and
+     * the calling one, in no particular order, and returns when all are
+     * done. task must not throw. Concurrent calls run one after the other.
+     * A call from inside a task of the same pool (e.g. nested parallel_*
+     * searches on shared()) runs its loop serially on the calling thread.
+     */
+    void parallel_for(size_t count, const std::function<void(size_t)> &task);
+
+private:
+    /* The iterations [next, end) left to one thread; others steal from end */
+    struct range {
+        std::mutex lock;
+        size_t next = 0, end = 0;
+    };
+
+    std::vector<std::thread> workers;
+    std::unique_ptr<range[]> ranges;  /* one per thread, the caller's last */
+    std::mutex callLock;              /* one parallel_for() at a time */
+    std::mutex jobLock;
+    std::condition_variable jobReady, jobDone;
+    const std::function<void(size_t)> *job;
+    uint64_t generation;  /* bumped per parallel_for(), wakes the workers */
+    size_t busy;          /* workers still running the current job */
+    bool stopping;
+
+    void workerLoop(size_t self);
+    /* Runs iterations from its own range, then steals, until none is left */
+    void participate(size_t self);
+    bool take(size_t self, size_t &index);
+};
+
+#endif
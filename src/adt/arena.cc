@@ -0,0 +1,51 @@
+/**
+ * File: arena.cc
+ * ---------------------------
+ * Implements class arena.
+ */
+
+#include "adt/arena.h"
+#include <algorithm>
+
+const size_t adt::arena::max_chunk_size;
+
+adt::arena::arena(size_t chunk_size)
+: cur(nullptr), end(nullptr),
+  nextChunkSize(std::max<size_t>(std::min(chunk_size, max_chunk_size), 64)),
+  used(0), reserved(0) {}
+
+void *adt::arena::allocateSlow(size_t n, size_t align) {
+    assert(align != 0 && (align & (align - 1)) == 0 && "Alignment is not a power of 2.");
+    size_t size = n + align - 1;
+    if (size > nextChunkSize) {
+        /* too large to share a chunk: gets its own, and the current chunk
+         * keeps bumping */
+        chunks.emplace_back(new char[size]);
+        chunkSizes.push_back(size);
+        reserved += size;
+        used += n;
+        uintptr_t p = (uintptr_t)chunks.back().get();
+        return (void *)((p + (align - 1)) & ~(uintptr_t)(align - 1));
+    }
+    chunks.emplace_back(new char[nextChunkSize]);
+    chunkSizes.push_back(nextChunkSize);
+    reserved += nextChunkSize;
+    cur = chunks.back().get();
+    end = cur + nextChunkSize;
+    nextChunkSize = std::min(nextChunkSize * 2, max_chunk_size);
+    return allocate(n, align);
+}
+
+void adt::arena::reset() {
+    used = 0;
+    if (chunks.empty()) { return; }
+    /* keeps the largest chunk, which the next allocations are bumped from */
+    size_t largest = std::max_element(chunkSizes.begin(), chunkSizes.end()) - chunkSizes.begin();
+    std::swap(chunks[0], chunks[largest]);
+    std::swap(chunkSizes[0], chunkSizes[largest]);
+    chunks.resize(1);
+    chunkSizes.resize(1);
+    reserved = chunkSizes[0];
+    cur = chunks[0].get();
+    end = cur + chunkSizes[0];
+}
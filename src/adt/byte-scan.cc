@@ -0,0 +1,985 @@
+/**
+ * File: byte-scan.cc
+ * ---------------------------
+ * Implements the byte scanning kernels declared in byte-scan.h.
+ * The SIMD versions are compiled with per-function target attributes, so this
+ * file needs no -m flags and the binary still runs on a plain x86-64 CPU.
+ */
+
+#include "byte-scan.h"
+#include <cstring>
+#include <cassert>
+
+#if defined(__x86_64__)
+#define BYTE_SCAN_X86 1
+#include <immintrin.h>
+#endif
+
+namespace {
+
+/* Scalar kernels: the fallback, and the tail handler of the SIMD kernels */
+
+size_t findScalar(const char *s, size_t n, char c) {
+    for (size_t i = 0; i != n; ++i) {
+        if (s[i] == c) { return i; }
+    }
+    return adt::byte_scan::npos;
+}
+
+size_t rfindScalar(const char *s, size_t n, char c) {
+    for (size_t i = n; i != 0; --i) {
+        if (s[i - 1] == c) { return i - 1; }
+    }
+    return adt::byte_scan::npos;
+}
+
+size_t countScalar(const char *s, size_t n, char c) {
+    size_t count = 0;
+    for (size_t i = 0; i != n; ++i) { /* plays with cache locality */
+        if (s[i] == c) { ++count; }
+    }
+    return count;
+}
+
+void matchBitmapScalar(const char *s, size_t n, char c, uint64_t *out) {
+    for (size_t k = 0; k * 64 < n; ++k) {
+        uint64_t bits = 0;
+        for (size_t j = 0, e = n - k * 64 < 64 ? n - k * 64 : 64; j != e; ++j) {
+            bits |= (uint64_t)(s[k * 64 + j] == c) << j;
+        }
+        out[k] = bits;
+    }
+}
+
+/* Class membership of a byte, the reference for the vector versions */
+template <int Cls>
+inline bool inClass(unsigned char c) {
+    switch (Cls) {
+    case adt::byte_scan::class_space:
+        return c == ' ' || (unsigned char)(c - '\t') < 5;
+    case adt::byte_scan::class_digit:
+        return (unsigned char)(c - '0') < 10;
+    default:
+        return (unsigned char)(c - '0') < 10 || (unsigned char)((c | 0x20) - 'a') < 26;
+    }
+}
+
+template <int Cls>
+size_t findClassScalar(const char *s, size_t n, bool negate) {
+    for (size_t i = 0; i != n; ++i) {
+        if (inClass<Cls>(s[i]) != negate) { return i; }
+    }
+    return adt::byte_scan::npos;
+}
+
+template <int Cls>
+size_t rfindClassScalar(const char *s, size_t n, bool negate) {
+    for (size_t i = n; i != 0; --i) {
+        if (inClass<Cls>(s[i - 1]) != negate) { return i - 1; }
+    }
+    return adt::byte_scan::npos;
+}
+
+/* Turns a kernel template over the class into a kernel taking the class id */
+#define DISPATCH_CLASS(KERNEL)                                                 \
+    size_t KERNEL(const char *s, size_t n, int cls, bool negate) {             \
+        switch (cls) {                                                         \
+        case adt::byte_scan::class_space: return KERNEL<0>(s, n, negate);      \
+        case adt::byte_scan::class_digit: return KERNEL<1>(s, n, negate);      \
+        default: return KERNEL<2>(s, n, negate);                               \
+        }                                                                      \
+    }
+
+DISPATCH_CLASS(findClassScalar)
+DISPATCH_CLASS(rfindClassScalar)
+
+inline bool inSet(const uint64_t *bits, unsigned char c) {
+    return (bits[c / 64] >> (c % 64)) & 1;
+}
+
+size_t findSetScalar(const char *s, size_t n, const uint64_t *bits,
+                     const unsigned char *, bool negate) {
+    for (size_t i = 0; i != n; ++i) {
+        if (inSet(bits, s[i]) != negate) { return i; }
+    }
+    return adt::byte_scan::npos;
+}
+
+size_t rfindSetScalar(const char *s, size_t n, const uint64_t *bits,
+                      const unsigned char *, bool negate) {
+    for (size_t i = n; i != 0; --i) {
+        if (inSet(bits, s[i - 1]) != negate) { return i - 1; }
+    }
+    return adt::byte_scan::npos;
+}
+
+/* Case conversion flips the 0x20 bit of the letters of the other case, the
+ * ones in [first, first + 26) */
+void convertCaseScalar(char *dst, const char *src, size_t n, bool upper) {
+    const unsigned char first = upper ? 'a' : 'A';
+    for (size_t i = 0; i != n; ++i) {
+        unsigned char c = src[i];
+        dst[i] = (char)((unsigned char)(c - first) < 26 ? c ^ 0x20 : c);
+    }
+}
+
+inline unsigned char lowerScalar(unsigned char c) {
+    return (unsigned char)(c - 'A') < 26 ? c | 0x20 : c;
+}
+
+size_t mismatchInsensitiveScalar(const char *a, const char *b, size_t n) {
+    for (size_t i = 0; i != n; ++i) {
+        if (lowerScalar(a[i]) != lowerScalar(b[i])) { return i; }
+    }
+    return adt::byte_scan::npos;
+}
+
+size_t findSubstrInsensitiveScalar(const char *s, size_t n, const char *p, size_t m) {
+    const unsigned char first = lowerScalar(p[0]), last = lowerScalar(p[m - 1]);
+    for (size_t i = 0, e = n - m + 1; i != e; ++i) {
+        if (lowerScalar(s[i]) == first && lowerScalar(s[i + m - 1]) == last
+            && mismatchInsensitiveScalar(s + i, p, m) == adt::byte_scan::npos) {
+            return i;
+        }
+    }
+    return adt::byte_scan::npos;
+}
+
+size_t findSubstrScalar(const char *s, size_t n, const char *p, size_t m,
+                        size_t a, size_t b) {
+    const char ca = p[a], cb = p[b];
+    for (size_t i = 0, e = n - m + 1; i != e; ++i) {
+        if (s[i + a] == ca && s[i + b] == cb
+            && std::memcmp(s + i, p, m) == 0) { return i; }
+    }
+    return adt::byte_scan::npos;
+}
+
+size_t rfindSubstrScalar(const char *s, size_t n, const char *p, size_t m,
+                         size_t a, size_t b) {
+    const char ca = p[a], cb = p[b];
+    for (size_t i = n - m + 1; i != 0; --i) {
+        if (s[i - 1 + a] == ca && s[i - 1 + b] == cb
+            && std::memcmp(s + i - 1, p, m) == 0) { return i - 1; }
+    }
+    return adt::byte_scan::npos;
+}
+
+/* Verifies the candidates in a filter byte match mask with memcmp */
+template <typename Mask>
+inline size_t verifyCandidates(Mask mask, const char *s, size_t i,
+                               const char *p, size_t m) {
+    while (mask) {
+        size_t j = i + __builtin_ctzll(mask);
+        if (std::memcmp(s + j, p, m) == 0) { return j; }
+        mask &= mask - 1; /* clears the lowest set bit */
+    }
+    return adt::byte_scan::npos;
+}
+
+/* The same as verifyCandidates(), but tries the highest candidate first */
+template <typename Mask>
+inline size_t rverifyCandidates(Mask mask, const char *s, size_t i,
+                                const char *p, size_t m) {
+    while (mask) {
+        unsigned bit = 63 - __builtin_clzll(mask);
+        if (std::memcmp(s + i + bit, p, m) == 0) { return i + bit; }
+        mask &= ~((Mask)1 << bit);
+    }
+    return adt::byte_scan::npos;
+}
+
+/* Scans the candidates [s + i, s + n - m] left by a vector loop */
+inline size_t findSubstrTail(const char *s, size_t i, size_t n,
+                             const char *p, size_t m, size_t a, size_t b) {
+    size_t pos = findSubstrScalar(s + i, n - i, p, m, a, b);
+    return pos == adt::byte_scan::npos ? pos : i + pos;
+}
+
+/* Scans the tail [s + i, s + n) with the scalar kernel, keeping npos intact */
+inline size_t findTail(const char *s, size_t i, size_t n, char c) {
+    size_t pos = findScalar(s + i, n - i, c);
+    return pos == adt::byte_scan::npos ? pos : i + pos;
+}
+
+#ifdef BYTE_SCAN_X86
+
+/* In the reverse kernels, i is the start of the next unscanned block from the
+ * end, and the head [s, s + i) is left to the scalar kernel. */
+
+size_t findSse2(const char *s, size_t n, char c) {
+    const __m128i needle = _mm_set1_epi8(c);
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(s + i));
+        unsigned mask = _mm_movemask_epi8(_mm_cmpeq_epi8(v, needle));
+        if (mask) { return i + __builtin_ctz(mask); }
+    }
+    return findTail(s, i, n, c);
+}
+
+size_t rfindSse2(const char *s, size_t n, char c) {
+    const __m128i needle = _mm_set1_epi8(c);
+    size_t i = n;
+    for (; i >= 16; i -= 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(s + i - 16));
+        unsigned mask = _mm_movemask_epi8(_mm_cmpeq_epi8(v, needle));
+        if (mask) { return i - 16 + (31 - __builtin_clz(mask)); }
+    }
+    return rfindScalar(s, i, c);
+}
+
+/* A 64-byte block is four 16-bit movemasks; the partial block at the end is
+ * left to the scalar kernel */
+void matchBitmapSse2(const char *s, size_t n, char c, uint64_t *out) {
+    const __m128i needle = _mm_set1_epi8(c);
+    size_t k = 0;
+    for (; k * 64 + 64 <= n; ++k) {
+        const __m128i *p = reinterpret_cast<const __m128i *>(s + k * 64);
+        uint64_t m0 = (unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128(p), needle));
+        uint64_t m1 = (unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128(p + 1), needle));
+        uint64_t m2 = (unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128(p + 2), needle));
+        uint64_t m3 = (unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128(p + 3), needle));
+        out[k] = m0 | (m1 << 16) | (m2 << 32) | (m3 << 48);
+    }
+    matchBitmapScalar(s + k * 64, n - k * 64, c, out + k);
+}
+
+/* Bytes in [lo, lo + width): shifted to [-128, -128 + width), so a signed
+ * comparison does the unsigned range check. */
+inline __m128i rangeSse2(__m128i v, char lo, int width) {
+    __m128i x = _mm_xor_si128(_mm_sub_epi8(v, _mm_set1_epi8(lo)), _mm_set1_epi8((char)0x80));
+    return _mm_cmpgt_epi8(_mm_set1_epi8((char)(-128 + width)), x);
+}
+
+template <int Cls>
+inline __m128i classSse2(__m128i v) {
+    switch (Cls) {
+    case adt::byte_scan::class_space:
+        return _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(' ')), rangeSse2(v, '\t', 5));
+    case adt::byte_scan::class_digit:
+        return rangeSse2(v, '0', 10);
+    default:
+        return _mm_or_si128(rangeSse2(v, '0', 10),
+                            rangeSse2(_mm_or_si128(v, _mm_set1_epi8(0x20)), 'a', 26));
+    }
+}
+
+template <int Cls>
+size_t findClassSse2(const char *s, size_t n, bool negate) {
+    const unsigned flip = negate ? 0xffff : 0;
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(s + i));
+        unsigned mask = _mm_movemask_epi8(classSse2<Cls>(v)) ^ flip;
+        if (mask) { return i + __builtin_ctz(mask); }
+    }
+    size_t pos = findClassScalar<Cls>(s + i, n - i, negate);
+    return pos == adt::byte_scan::npos ? pos : i + pos;
+}
+
+template <int Cls>
+size_t rfindClassSse2(const char *s, size_t n, bool negate) {
+    const unsigned flip = negate ? 0xffff : 0;
+    size_t i = n;
+    for (; i >= 16; i -= 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(s + i - 16));
+        unsigned mask = _mm_movemask_epi8(classSse2<Cls>(v)) ^ flip;
+        if (mask) { return i - 16 + (31 - __builtin_clz(mask)); }
+    }
+    return rfindClassScalar<Cls>(s, i, negate);
+}
+
+DISPATCH_CLASS(findClassSse2)
+DISPATCH_CLASS(rfindClassSse2)
+
+/* Converting a converted byte again changes nothing, so the tail is done as
+ * one more vector ending at n, overlapping the last full one (both when dst
+ * is src and when they do not overlap). */
+void convertCaseSse2(char *dst, const char *src, size_t n, bool upper) {
+    if (n < 16) { return convertCaseScalar(dst, src, n, upper); }
+    const char first = upper ? 'a' : 'A';
+    const __m128i flip = _mm_set1_epi8(0x20);
+    for (size_t i = 0;; i += 16) {
+        if (i + 16 > n) { i = n - 16; }
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+        v = _mm_xor_si128(v, _mm_and_si128(rangeSse2(v, first, 26), flip));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), v);
+        if (i + 16 == n) { return; }
+    }
+}
+
+inline __m128i lowerSse2(__m128i v) {
+    return _mm_or_si128(v, _mm_and_si128(rangeSse2(v, 'A', 26), _mm_set1_epi8(0x20)));
+}
+
+size_t mismatchInsensitiveSse2(const char *a, const char *b, size_t n) {
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m128i va = lowerSse2(_mm_loadu_si128(reinterpret_cast<const __m128i *>(a + i)));
+        __m128i vb = lowerSse2(_mm_loadu_si128(reinterpret_cast<const __m128i *>(b + i)));
+        unsigned mask = _mm_movemask_epi8(_mm_cmpeq_epi8(va, vb)) ^ 0xffff;
+        if (mask) { return i + __builtin_ctz(mask); }
+    }
+    size_t pos = mismatchInsensitiveScalar(a + i, b + i, n - i);
+    return pos == adt::byte_scan::npos ? pos : i + pos;
+}
+
+size_t findSubstrInsensitiveSse2(const char *s, size_t n, const char *p, size_t m) {
+    const __m128i first = _mm_set1_epi8((char)lowerScalar(p[0]));
+    const __m128i last = _mm_set1_epi8((char)lowerScalar(p[m - 1]));
+    size_t i = 0;
+    for (; i + m - 1 + 16 <= n; i += 16) {
+        __m128i sa = lowerSse2(_mm_loadu_si128(reinterpret_cast<const __m128i *>(s + i)));
+        __m128i sb = lowerSse2(_mm_loadu_si128(reinterpret_cast<const __m128i *>(s + i + m - 1)));
+        unsigned mask = _mm_movemask_epi8(
+            _mm_and_si128(_mm_cmpeq_epi8(sa, first), _mm_cmpeq_epi8(sb, last)));
+        while (mask) {
+            size_t j = i + __builtin_ctz(mask);
+            if (mismatchInsensitiveSse2(s + j, p, m) == adt::byte_scan::npos) { return j; }
+            mask &= mask - 1;
+        }
+    }
+    size_t pos = findSubstrInsensitiveScalar(s + i, n - i, p, m);
+    return pos == adt::byte_scan::npos ? pos : i + pos;
+}
+
+/* Set membership by nibble lookup. PSHUFB only looks at the low nibble and
+ * the top bit of its indices: a byte below 0x80 picks its row (the high
+ * nibbles 0-7 present with that low nibble) from the first table, and zero
+ * from the second, and the other way round for a byte from 0x80 up. The row
+ * is then tested against the bit of the byte's high nibble. */
+__attribute__((target("ssse3")))
+inline __m128i inSetSsse3(__m128i v, __m128i rowsLo, __m128i rowsHi) {
+    const __m128i bitOf = _mm_setr_epi8(1, 2, 4, 8, 16, 32, 64, (char)128,
+                                        1, 2, 4, 8, 16, 32, 64, (char)128);
+    __m128i high = _mm_and_si128(_mm_srli_epi16(v, 4), _mm_set1_epi8(0x0f));
+    __m128i row = _mm_or_si128(
+        _mm_shuffle_epi8(rowsLo, v),
+        _mm_shuffle_epi8(rowsHi, _mm_xor_si128(v, _mm_set1_epi8((char)0x80))));
+    __m128i bit = _mm_shuffle_epi8(bitOf, high);
+    return _mm_cmpeq_epi8(_mm_and_si128(row, bit), bit);
+}
+
+__attribute__((target("ssse3")))
+size_t findSetSsse3(const char *s, size_t n, const uint64_t *bits,
+                    const unsigned char *nibbles, bool negate) {
+    const __m128i rowsLo = _mm_loadu_si128(reinterpret_cast<const __m128i *>(nibbles));
+    const __m128i rowsHi = _mm_loadu_si128(reinterpret_cast<const __m128i *>(nibbles + 16));
+    const unsigned flip = negate ? 0xffff : 0;
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(s + i));
+        unsigned mask = _mm_movemask_epi8(inSetSsse3(v, rowsLo, rowsHi)) ^ flip;
+        if (mask) { return i + __builtin_ctz(mask); }
+    }
+    size_t pos = findSetScalar(s + i, n - i, bits, nibbles, negate);
+    return pos == adt::byte_scan::npos ? pos : i + pos;
+}
+
+__attribute__((target("ssse3")))
+size_t rfindSetSsse3(const char *s, size_t n, const uint64_t *bits,
+                     const unsigned char *nibbles, bool negate) {
+    const __m128i rowsLo = _mm_loadu_si128(reinterpret_cast<const __m128i *>(nibbles));
+    const __m128i rowsHi = _mm_loadu_si128(reinterpret_cast<const __m128i *>(nibbles + 16));
+    const unsigned flip = negate ? 0xffff : 0;
+    size_t i = n;
+    for (; i >= 16; i -= 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(s + i - 16));
+        unsigned mask = _mm_movemask_epi8(inSetSsse3(v, rowsLo, rowsHi)) ^ flip;
+        if (mask) { return i - 16 + (31 - __builtin_clz(mask)); }
+    }
+    return rfindSetScalar(s, i, bits, nibbles, negate);
+}
+
+/* Equal bytes compare to 0xff (i.e. -1), so subtracting the comparison result
+ * bumps a per-lane byte counter; the counters are flushed into 64-bit sums
+ * with psadbw before they can overflow (every 255 blocks). */
+size_t countSse2(const char *s, size_t n, char c) {
+    const __m128i needle = _mm_set1_epi8(c);
+    const __m128i zero = _mm_setzero_si128();
+    __m128i sums = zero;
+    size_t i = 0;
+    while (i + 16 <= n) {
+        __m128i acc = zero;
+        for (int k = 0; k < 255 && i + 16 <= n; ++k, i += 16) {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(s + i));
+            acc = _mm_sub_epi8(acc, _mm_cmpeq_epi8(v, needle));
+        }
+        sums = _mm_add_epi64(sums, _mm_sad_epu8(acc, zero));
+    }
+    size_t count = (size_t)_mm_cvtsi128_si64(sums)
+                 + (size_t)_mm_cvtsi128_si64(_mm_unpackhi_epi64(sums, sums));
+    return count + countScalar(s + i, n - i, c);
+}
+
+size_t findSubstrSse2(const char *s, size_t n, const char *p, size_t m,
+                      size_t a, size_t b) {
+    const __m128i va = _mm_set1_epi8(p[a]);
+    const __m128i vb = _mm_set1_epi8(p[b]);
+    size_t i = 0;
+    for (; i + m - 1 + 16 <= n; i += 16) {
+        __m128i sa = _mm_loadu_si128(reinterpret_cast<const __m128i *>(s + i + a));
+        __m128i sb = _mm_loadu_si128(reinterpret_cast<const __m128i *>(s + i + b));
+        unsigned mask = _mm_movemask_epi8(
+            _mm_and_si128(_mm_cmpeq_epi8(sa, va), _mm_cmpeq_epi8(sb, vb)));
+        size_t pos = verifyCandidates(mask, s, i, p, m);
+        if (pos != adt::byte_scan::npos) { return pos; }
+    }
+    return findSubstrTail(s, i, n, p, m, a, b);
+}
+
+size_t rfindSubstrSse2(const char *s, size_t n, const char *p, size_t m,
+                       size_t a, size_t b) {
+    const __m128i va = _mm_set1_epi8(p[a]);
+    const __m128i vb = _mm_set1_epi8(p[b]);
+    size_t i = n - m + 1; /* number of candidate positions left */
+    for (; i >= 16; i -= 16) {
+        const char *blk = s + i - 16;
+        __m128i sa = _mm_loadu_si128(reinterpret_cast<const __m128i *>(blk + a));
+        __m128i sb = _mm_loadu_si128(reinterpret_cast<const __m128i *>(blk + b));
+        unsigned mask = _mm_movemask_epi8(
+            _mm_and_si128(_mm_cmpeq_epi8(sa, va), _mm_cmpeq_epi8(sb, vb)));
+        size_t pos = rverifyCandidates(mask, s, i - 16, p, m);
+        if (pos != adt::byte_scan::npos) { return pos; }
+    }
+    return rfindSubstrScalar(s, i + m - 1, p, m, a, b);
+}
+
+__attribute__((target("avx2")))
+size_t findAvx2(const char *s, size_t n, char c) {
+    const __m256i needle = _mm256_set1_epi8(c);
+    size_t i = 0;
+    /* two vectors per iteration to keep both load ports busy */
+    for (; i + 64 <= n; i += 64) {
+        __m256i v0 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(s + i));
+        __m256i v1 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(s + i + 32));
+        __m256i eq0 = _mm256_cmpeq_epi8(v0, needle);
+        __m256i eq1 = _mm256_cmpeq_epi8(v1, needle);
+        if (!_mm256_testz_si256(_mm256_or_si256(eq0, eq1), _mm256_or_si256(eq0, eq1))) {
+            unsigned mask0 = _mm256_movemask_epi8(eq0);
+            if (mask0) { return i + __builtin_ctz(mask0); }
+            return i + 32 + __builtin_ctz((unsigned)_mm256_movemask_epi8(eq1));
+        }
+    }
+    for (; i + 32 <= n; i += 32) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(s + i));
+        unsigned mask = _mm256_movemask_epi8(_mm256_cmpeq_epi8(v, needle));
+        if (mask) { return i + __builtin_ctz(mask); }
+    }
+    return findTail(s, i, n, c);
+}
+
+__attribute__((target("avx2")))
+size_t rfindAvx2(const char *s, size_t n, char c) {
+    const __m256i needle = _mm256_set1_epi8(c);
+    size_t i = n;
+    for (; i >= 32; i -= 32) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(s + i - 32));
+        unsigned mask = _mm256_movemask_epi8(_mm256_cmpeq_epi8(v, needle));
+        if (mask) { return i - 32 + (31 - __builtin_clz(mask)); }
+    }
+    return rfindScalar(s, i, c);
+}
+
+__attribute__((target("avx2")))
+void matchBitmapAvx2(const char *s, size_t n, char c, uint64_t *out) {
+    const __m256i needle = _mm256_set1_epi8(c);
+    size_t k = 0;
+    for (; k * 64 + 64 <= n; ++k) {
+        const __m256i *p = reinterpret_cast<const __m256i *>(s + k * 64);
+        uint64_t lo = (unsigned)_mm256_movemask_epi8(
+            _mm256_cmpeq_epi8(_mm256_loadu_si256(p), needle));
+        uint64_t hi = (unsigned)_mm256_movemask_epi8(
+            _mm256_cmpeq_epi8(_mm256_loadu_si256(p + 1), needle));
+        out[k] = lo | (hi << 32);
+    }
+    matchBitmapScalar(s + k * 64, n - k * 64, c, out + k);
+}
+
+__attribute__((target("avx2")))
+size_t countAvx2(const char *s, size_t n, char c) {
+    const __m256i needle = _mm256_set1_epi8(c);
+    const __m256i zero = _mm256_setzero_si256();
+    __m256i sums = zero;
+    size_t i = 0;
+    while (i + 32 <= n) {
+        __m256i acc = zero;
+        for (int k = 0; k < 255 && i + 32 <= n; ++k, i += 32) {
+            __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(s + i));
+            acc = _mm256_sub_epi8(acc, _mm256_cmpeq_epi8(v, needle));
+        }
+        sums = _mm256_add_epi64(sums, _mm256_sad_epu8(acc, zero));
+    }
+    size_t count = (size_t)_mm256_extract_epi64(sums, 0) + (size_t)_mm256_extract_epi64(sums, 1)
+                 + (size_t)_mm256_extract_epi64(sums, 2) + (size_t)_mm256_extract_epi64(sums, 3);
+    return count + countScalar(s + i, n - i, c);
+}
+
+__attribute__((target("avx2")))
+size_t findSubstrAvx2(const char *s, size_t n, const char *p, size_t m,
+                      size_t a, size_t b) {
+    const __m256i va = _mm256_set1_epi8(p[a]);
+    const __m256i vb = _mm256_set1_epi8(p[b]);
+    size_t i = 0;
+    for (; i + m - 1 + 32 <= n; i += 32) {
+        __m256i sa = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(s + i + a));
+        __m256i sb = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(s + i + b));
+        unsigned mask = _mm256_movemask_epi8(
+            _mm256_and_si256(_mm256_cmpeq_epi8(sa, va), _mm256_cmpeq_epi8(sb, vb)));
+        size_t pos = verifyCandidates(mask, s, i, p, m);
+        if (pos != adt::byte_scan::npos) { return pos; }
+    }
+    return findSubstrTail(s, i, n, p, m, a, b);
+}
+
+__attribute__((target("avx2")))
+size_t rfindSubstrAvx2(const char *s, size_t n, const char *p, size_t m,
+                       size_t a, size_t b) {
+    const __m256i va = _mm256_set1_epi8(p[a]);
+    const __m256i vb = _mm256_set1_epi8(p[b]);
+    size_t i = n - m + 1;
+    for (; i >= 32; i -= 32) {
+        const char *blk = s + i - 32;
+        __m256i sa = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(blk + a));
+        __m256i sb = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(blk + b));
+        unsigned mask = _mm256_movemask_epi8(
+            _mm256_and_si256(_mm256_cmpeq_epi8(sa, va), _mm256_cmpeq_epi8(sb, vb)));
+        size_t pos = rverifyCandidates(mask, s, i - 32, p, m);
+        if (pos != adt::byte_scan::npos) { return pos; }
+    }
+    return rfindSubstrScalar(s, i + m - 1, p, m, a, b);
+}
+
+__attribute__((target("avx2")))
+inline __m256i rangeAvx2(__m256i v, char lo, int width) {
+    __m256i x = _mm256_xor_si256(_mm256_sub_epi8(v, _mm256_set1_epi8(lo)),
+                                 _mm256_set1_epi8((char)0x80));
+    return _mm256_cmpgt_epi8(_mm256_set1_epi8((char)(-128 + width)), x);
+}
+
+template <int Cls>
+__attribute__((target("avx2")))
+inline __m256i classAvx2(__m256i v) {
+    switch (Cls) {
+    case adt::byte_scan::class_space:
+        return _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8(' ')),
+                               rangeAvx2(v, '\t', 5));
+    case adt::byte_scan::class_digit:
+        return rangeAvx2(v, '0', 10);
+    default:
+        return _mm256_or_si256(rangeAvx2(v, '0', 10),
+                               rangeAvx2(_mm256_or_si256(v, _mm256_set1_epi8(0x20)), 'a', 26));
+    }
+}
+
+template <int Cls>
+__attribute__((target("avx2")))
+size_t findClassAvx2(const char *s, size_t n, bool negate) {
+    const unsigned flip = negate ? 0xffffffffu : 0;
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(s + i));
+        unsigned mask = (unsigned)_mm256_movemask_epi8(classAvx2<Cls>(v)) ^ flip;
+        if (mask) { return i + __builtin_ctz(mask); }
+    }
+    size_t pos = findClassScalar<Cls>(s + i, n - i, negate);
+    return pos == adt::byte_scan::npos ? pos : i + pos;
+}
+
+template <int Cls>
+__attribute__((target("avx2")))
+size_t rfindClassAvx2(const char *s, size_t n, bool negate) {
+    const unsigned flip = negate ? 0xffffffffu : 0;
+    size_t i = n;
+    for (; i >= 32; i -= 32) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(s + i - 32));
+        unsigned mask = (unsigned)_mm256_movemask_epi8(classAvx2<Cls>(v)) ^ flip;
+        if (mask) { return i - 32 + (31 - __builtin_clz(mask)); }
+    }
+    return rfindClassScalar<Cls>(s, i, negate);
+}
+
+DISPATCH_CLASS(findClassAvx2)
+DISPATCH_CLASS(rfindClassAvx2)
+
+__attribute__((target("avx2")))
+void convertCaseAvx2(char *dst, const char *src, size_t n, bool upper) {
+    if (n < 32) { return convertCaseSse2(dst, src, n, upper); }
+    const char first = upper ? 'a' : 'A';
+    const __m256i flip = _mm256_set1_epi8(0x20);
+    for (size_t i = 0;; i += 32) {
+        if (i + 32 > n) { i = n - 32; } /* see convertCaseSse2() */
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i));
+        v = _mm256_xor_si256(v, _mm256_and_si256(rangeAvx2(v, first, 26), flip));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i), v);
+        if (i + 32 == n) { return; }
+    }
+}
+
+__attribute__((target("avx2")))
+inline __m256i lowerAvx2(__m256i v) {
+    return _mm256_or_si256(v, _mm256_and_si256(rangeAvx2(v, 'A', 26), _mm256_set1_epi8(0x20)));
+}
+
+__attribute__((target("avx2")))
+size_t mismatchInsensitiveAvx2(const char *a, const char *b, size_t n) {
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        __m256i va = lowerAvx2(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(a + i)));
+        __m256i vb = lowerAvx2(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(b + i)));
+        unsigned mask = ~(unsigned)_mm256_movemask_epi8(_mm256_cmpeq_epi8(va, vb));
+        if (mask) { return i + __builtin_ctz(mask); }
+    }
+    size_t pos = mismatchInsensitiveSse2(a + i, b + i, n - i);
+    return pos == adt::byte_scan::npos ? pos : i + pos;
+}
+
+__attribute__((target("avx2")))
+size_t findSubstrInsensitiveAvx2(const char *s, size_t n, const char *p, size_t m) {
+    const __m256i first = _mm256_set1_epi8((char)lowerScalar(p[0]));
+    const __m256i last = _mm256_set1_epi8((char)lowerScalar(p[m - 1]));
+    size_t i = 0;
+    for (; i + m - 1 + 32 <= n; i += 32) {
+        __m256i sa = lowerAvx2(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(s + i)));
+        __m256i sb = lowerAvx2(_mm256_loadu_si256(
+            reinterpret_cast<const __m256i *>(s + i + m - 1)));
+        unsigned mask = (unsigned)_mm256_movemask_epi8(
+            _mm256_and_si256(_mm256_cmpeq_epi8(sa, first), _mm256_cmpeq_epi8(sb, last)));
+        while (mask) {
+            size_t j = i + __builtin_ctz(mask);
+            if (mismatchInsensitiveAvx2(s + j, p, m) == adt::byte_scan::npos) { return j; }
+            mask &= mask - 1;
+        }
+    }
+    size_t pos = findSubstrInsensitiveSse2(s + i, n - i, p, m);
+    return pos == adt::byte_scan::npos ? pos : i + pos;
+}
+
+/* The same as inSetSsse3(); VPSHUFB looks up within each 128-bit lane, so
+ * the tables are broadcast to both lanes */
+__attribute__((target("avx2")))
+inline __m256i inSetAvx2(__m256i v, __m256i rowsLo, __m256i rowsHi) {
+    const __m256i bitOf = _mm256_setr_epi8(1, 2, 4, 8, 16, 32, 64, (char)128,
+                                           1, 2, 4, 8, 16, 32, 64, (char)128,
+                                           1, 2, 4, 8, 16, 32, 64, (char)128,
+                                           1, 2, 4, 8, 16, 32, 64, (char)128);
+    __m256i high = _mm256_and_si256(_mm256_srli_epi16(v, 4), _mm256_set1_epi8(0x0f));
+    __m256i row = _mm256_or_si256(
+        _mm256_shuffle_epi8(rowsLo, v),
+        _mm256_shuffle_epi8(rowsHi, _mm256_xor_si256(v, _mm256_set1_epi8((char)0x80))));
+    __m256i bit = _mm256_shuffle_epi8(bitOf, high);
+    return _mm256_cmpeq_epi8(_mm256_and_si256(row, bit), bit);
+}
+
+__attribute__((target("avx2")))
+size_t findSetAvx2(const char *s, size_t n, const uint64_t *bits,
+                   const unsigned char *nibbles, bool negate) {
+    const __m256i rowsLo = _mm256_broadcastsi128_si256(
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(nibbles)));
+    const __m256i rowsHi = _mm256_broadcastsi128_si256(
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(nibbles + 16)));
+    const unsigned flip = negate ? 0xffffffffu : 0;
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(s + i));
+        unsigned mask = (unsigned)_mm256_movemask_epi8(inSetAvx2(v, rowsLo, rowsHi)) ^ flip;
+        if (mask) { return i + __builtin_ctz(mask); }
+    }
+    size_t pos = findSetScalar(s + i, n - i, bits, nibbles, negate);
+    return pos == adt::byte_scan::npos ? pos : i + pos;
+}
+
+__attribute__((target("avx2")))
+size_t rfindSetAvx2(const char *s, size_t n, const uint64_t *bits,
+                    const unsigned char *nibbles, bool negate) {
+    const __m256i rowsLo = _mm256_broadcastsi128_si256(
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(nibbles)));
+    const __m256i rowsHi = _mm256_broadcastsi128_si256(
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(nibbles + 16)));
+    const unsigned flip = negate ? 0xffffffffu : 0;
+    size_t i = n;
+    for (; i >= 32; i -= 32) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(s + i - 32));
+        unsigned mask = (unsigned)_mm256_movemask_epi8(inSetAvx2(v, rowsLo, rowsHi)) ^ flip;
+        if (mask) { return i - 32 + (31 - __builtin_clz(mask)); }
+    }
+    return rfindSetScalar(s, i, bits, nibbles, negate);
+}
+
+__attribute__((target("avx512f,avx512bw")))
+size_t findAvx512(const char *s, size_t n, char c) {
+    const __m512i needle = _mm512_set1_epi8(c);
+    size_t i = 0;
+    for (; i + 64 <= n; i += 64) {
+        __m512i v = _mm512_loadu_si512(s + i);
+        __mmask64 mask = _mm512_cmpeq_epi8_mask(v, needle);
+        if (mask) { return i + __builtin_ctzll(mask); }
+    }
+    if (i == n) { return adt::byte_scan::npos; }
+    /* masked load: the tail never touches memory past s + n */
+    __mmask64 live = ((__mmask64)-1) >> (64 - (n - i));
+    __m512i v = _mm512_maskz_loadu_epi8(live, s + i);
+    __mmask64 mask = _mm512_mask_cmpeq_epi8_mask(live, v, needle);
+    return mask ? i + __builtin_ctzll(mask) : adt::byte_scan::npos;
+}
+
+__attribute__((target("avx512f,avx512bw")))
+size_t rfindAvx512(const char *s, size_t n, char c) {
+    const __m512i needle = _mm512_set1_epi8(c);
+    size_t i = n;
+    for (; i >= 64; i -= 64) {
+        __m512i v = _mm512_loadu_si512(s + i - 64);
+        __mmask64 mask = _mm512_cmpeq_epi8_mask(v, needle);
+        if (mask) { return i - 64 + (63 - __builtin_clzll(mask)); }
+    }
+    if (i == 0) { return adt::byte_scan::npos; }
+    __mmask64 live = ((__mmask64)-1) >> (64 - i);
+    __m512i v = _mm512_maskz_loadu_epi8(live, s);
+    __mmask64 mask = _mm512_mask_cmpeq_epi8_mask(live, v, needle);
+    return mask ? 63 - __builtin_clzll(mask) : adt::byte_scan::npos;
+}
+
+/* A compare mask is exactly one bitmap word */
+__attribute__((target("avx512f,avx512bw")))
+void matchBitmapAvx512(const char *s, size_t n, char c, uint64_t *out) {
+    const __m512i needle = _mm512_set1_epi8(c);
+    size_t k = 0;
+    for (; k * 64 + 64 <= n; ++k) {
+        out[k] = _mm512_cmpeq_epi8_mask(_mm512_loadu_si512(s + k * 64), needle);
+    }
+    if (k * 64 == n) { return; }
+    __mmask64 live = ((__mmask64)-1) >> (64 - (n - k * 64));
+    out[k] = _mm512_mask_cmpeq_epi8_mask(live, _mm512_maskz_loadu_epi8(live, s + k * 64), needle);
+}
+
+__attribute__((target("avx512f,avx512bw,popcnt")))
+size_t countAvx512(const char *s, size_t n, char c) {
+    const __m512i needle = _mm512_set1_epi8(c);
+    size_t count = 0, i = 0;
+    for (; i + 64 <= n; i += 64) {
+        __m512i v = _mm512_loadu_si512(s + i);
+        count += __builtin_popcountll(_mm512_cmpeq_epi8_mask(v, needle));
+    }
+    if (i == n) { return count; }
+    __mmask64 live = ((__mmask64)-1) >> (64 - (n - i));
+    __m512i v = _mm512_maskz_loadu_epi8(live, s + i);
+    return count + __builtin_popcountll(_mm512_mask_cmpeq_epi8_mask(live, v, needle));
+}
+
+__attribute__((target("avx512f,avx512bw")))
+size_t findSubstrAvx512(const char *s, size_t n, const char *p, size_t m,
+                        size_t a, size_t b) {
+    const __m512i va = _mm512_set1_epi8(p[a]);
+    const __m512i vb = _mm512_set1_epi8(p[b]);
+    size_t i = 0;
+    for (; i + m - 1 + 64 <= n; i += 64) {
+        __m512i sa = _mm512_loadu_si512(s + i + a);
+        __m512i sb = _mm512_loadu_si512(s + i + b);
+        __mmask64 mask = _mm512_mask_cmpeq_epi8_mask(
+            _mm512_cmpeq_epi8_mask(sa, va), sb, vb);
+        size_t pos = verifyCandidates(mask, s, i, p, m);
+        if (pos != adt::byte_scan::npos) { return pos; }
+    }
+    return findSubstrTail(s, i, n, p, m, a, b);
+}
+
+__attribute__((target("avx512f,avx512bw")))
+size_t rfindSubstrAvx512(const char *s, size_t n, const char *p, size_t m,
+                         size_t a, size_t b) {
+    const __m512i va = _mm512_set1_epi8(p[a]);
+    const __m512i vb = _mm512_set1_epi8(p[b]);
+    size_t i = n - m + 1;
+    for (; i >= 64; i -= 64) {
+        const char *blk = s + i - 64;
+        __m512i sa = _mm512_loadu_si512(blk + a);
+        __m512i sb = _mm512_loadu_si512(blk + b);
+        __mmask64 mask = _mm512_mask_cmpeq_epi8_mask(
+            _mm512_cmpeq_epi8_mask(sa, va), sb, vb);
+        size_t pos = rverifyCandidates(mask, s, i - 64, p, m);
+        if (pos != adt::byte_scan::npos) { return pos; }
+    }
+    return rfindSubstrScalar(s, i + m - 1, p, m, a, b);
+}
+
+__attribute__((target("avx512f,avx512bw")))
+void convertCaseAvx512(char *dst, const char *src, size_t n, bool upper) {
+    const __m512i first = _mm512_set1_epi8(upper ? 'a' : 'A');
+    const __m512i letters = _mm512_set1_epi8(26);
+    const __m512i flip = _mm512_set1_epi8(0x20);
+    size_t i = 0;
+    for (; i + 64 <= n; i += 64) {
+        __m512i v = _mm512_loadu_si512(src + i);
+        __mmask64 mask = _mm512_cmplt_epu8_mask(_mm512_sub_epi8(v, first), letters);
+        _mm512_storeu_si512(dst + i, _mm512_mask_blend_epi8(mask, v, _mm512_xor_si512(v, flip)));
+    }
+    if (i == n) { return; }
+    __mmask64 live = ((__mmask64)-1) >> (64 - (n - i));
+    __m512i v = _mm512_maskz_loadu_epi8(live, src + i);
+    __mmask64 mask = _mm512_cmplt_epu8_mask(_mm512_sub_epi8(v, first), letters);
+    _mm512_mask_storeu_epi8(dst + i, live,
+                            _mm512_mask_blend_epi8(mask, v, _mm512_xor_si512(v, flip)));
+}
+
+#endif /* BYTE_SCAN_X86 */
+
+#undef DISPATCH_CLASS
+
+/* The dispatch table, resolved once on first use (C++11 guarantees a
+ * thread-safe initialization of function-local statics). The tests replace
+ * it with set_isa(). */
+struct kernel_table {
+    const char *name;
+    size_t (*find)(const char *, size_t, char);
+    size_t (*rfind)(const char *, size_t, char);
+    size_t (*count)(const char *, size_t, char);
+    void (*matchBitmap)(const char *, size_t, char, uint64_t *);
+    size_t (*findSubstr)(const char *, size_t, const char *, size_t, size_t, size_t);
+    size_t (*rfindSubstr)(const char *, size_t, const char *, size_t, size_t, size_t);
+    size_t (*findClass)(const char *, size_t, int, bool);
+    size_t (*rfindClass)(const char *, size_t, int, bool);
+    size_t (*findSet)(const char *, size_t, const uint64_t *, const unsigned char *, bool);
+    size_t (*rfindSet)(const char *, size_t, const uint64_t *, const unsigned char *, bool);
+    void (*convertCase)(char *, const char *, size_t, bool);
+    size_t (*mismatchInsensitive)(const char *, const char *, size_t);
+    size_t (*findSubstrInsensitive)(const char *, size_t, const char *, size_t);
+};
+
+/* The instruction sets with kernels, from the least to the most capable */
+enum isa_level { isaScalar, isaSse2, isaAvx2, isaAvx512 };
+const char *const isaNames[] = { "scalar", "sse2", "avx2", "avx512" };
+
+/* The most capable instruction set of the running CPU */
+isa_level cpuLevel() {
+#ifdef BYTE_SCAN_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512bw") && __builtin_cpu_supports("popcnt")) {
+        return isaAvx512;
+    }
+    if (__builtin_cpu_supports("avx2")) { return isaAvx2; }
+    if (__builtin_cpu_supports("sse2")) { return isaSse2; }
+#endif
+    return isaScalar;
+}
+
+/* The kernels of an instruction set the CPU supports */
+kernel_table kernelsFor(isa_level level) {
+#ifdef BYTE_SCAN_X86
+    if (level == isaAvx512) {
+        return { "avx512", findAvx512, rfindAvx512, countAvx512, matchBitmapAvx512,
+                 findSubstrAvx512, rfindSubstrAvx512,
+                 findClassAvx2, rfindClassAvx2,
+                 findSetAvx2, rfindSetAvx2, convertCaseAvx512,
+                 mismatchInsensitiveAvx2, findSubstrInsensitiveAvx2 };
+    }
+    if (level == isaAvx2) {
+        return { "avx2", findAvx2, rfindAvx2, countAvx2, matchBitmapAvx2,
+                 findSubstrAvx2, rfindSubstrAvx2,
+                 findClassAvx2, rfindClassAvx2,
+                 findSetAvx2, rfindSetAvx2, convertCaseAvx2,
+                 mismatchInsensitiveAvx2, findSubstrInsensitiveAvx2 };
+    }
+    if (level == isaSse2) {
+        bool ssse3 = __builtin_cpu_supports("ssse3"); /* for PSHUFB */
+        return { "sse2", findSse2, rfindSse2, countSse2, matchBitmapSse2,
+                 findSubstrSse2, rfindSubstrSse2,
+                 findClassSse2, rfindClassSse2,
+                 ssse3 ? findSetSsse3 : findSetScalar,
+                 ssse3 ? rfindSetSsse3 : rfindSetScalar,
+                 convertCaseSse2,
+                 mismatchInsensitiveSse2, findSubstrInsensitiveSse2 };
+    }
+#endif
+    return { "scalar", findScalar, rfindScalar, countScalar, matchBitmapScalar,
+             findSubstrScalar, rfindSubstrScalar,
+             findClassScalar, rfindClassScalar,
+             findSetScalar, rfindSetScalar, convertCaseScalar,
+             mismatchInsensitiveScalar, findSubstrInsensitiveScalar };
+}
+
+/* The kernels in use: the CPU's best unless set_isa() chose others */
+kernel_table &kernels() {
+    static kernel_table table = kernelsFor(cpuLevel());
+    return table;
+}
+
+/* Resolves the kernels at startup, so no search pays for the first cpuid */
+const kernel_table &eagerKernels = kernels();
+
+} /* namespace */
+
+size_t adt::byte_scan::find(const char *s, size_t n, char c) {
+    return kernels().find(s, n, c);
+}
+
+size_t adt::byte_scan::rfind(const char *s, size_t n, char c) {
+    return kernels().rfind(s, n, c);
+}
+
+size_t adt::byte_scan::count(const char *s, size_t n, char c) {
+    return kernels().count(s, n, c);
+}
+
+void adt::byte_scan::match_bitmap(const char *s, size_t n, char c, uint64_t *out) {
+    kernels().matchBitmap(s, n, c, out);
+}
+
+size_t adt::byte_scan::find_substr(const char *s, size_t n,
+                                   const char *p, size_t m, size_t a, size_t b) {
+    assert(2 <= m && m <= n && "find_substr() needs 2 <= m <= n.");
+    assert(a < b && b < m && "find_substr() needs a < b < m.");
+    return kernels().findSubstr(s, n, p, m, a, b);
+}
+
+size_t adt::byte_scan::rfind_substr(const char *s, size_t n,
+                                    const char *p, size_t m, size_t a, size_t b) {
+    assert(2 <= m && m <= n && "rfind_substr() needs 2 <= m <= n.");
+    assert(a < b && b < m && "rfind_substr() needs a < b < m.");
+    return kernels().rfindSubstr(s, n, p, m, a, b);
+}
+
+size_t adt::byte_scan::find_class(const char *s, size_t n, int cls, bool negate) {
+    return kernels().findClass(s, n, cls, negate);
+}
+
+size_t adt::byte_scan::rfind_class(const char *s, size_t n, int cls, bool negate) {
+    return kernels().rfindClass(s, n, cls, negate);
+}
+
+size_t adt::byte_scan::find_set(const char *s, size_t n, const uint64_t *bits,
+                                const unsigned char *nibbles, bool negate) {
+    return kernels().findSet(s, n, bits, nibbles, negate);
+}
+
+size_t adt::byte_scan::rfind_set(const char *s, size_t n, const uint64_t *bits,
+                                 const unsigned char *nibbles, bool negate) {
+    return kernels().rfindSet(s, n, bits, nibbles, negate);
+}
+
+void adt::byte_scan::convert_case(char *dst, const char *src, size_t n, bool upper) {
+    kernels().convertCase(dst, src, n, upper);
+}
+
+size_t adt::byte_scan::mismatch_insensitive(const char *a, const char *b, size_t n) {
+    return kernels().mismatchInsensitive(a, b, n);
+}
+
+size_t adt::byte_scan::find_substr_insensitive(const char *s, size_t n,
+                                               const char *p, size_t m) {
+    assert(1 <= m && m <= n && "find_substr_insensitive() needs 1 <= m <= n.");
+    return kernels().findSubstrInsensitive(s, n, p, m);
+}
+
+const char *adt::byte_scan::isa_name() {
+    return kernels().name;
+}
+
+bool adt::byte_scan::set_isa(const char *name) {
+    for (int level = isaScalar; level <= cpuLevel(); ++level) {
+        if (std::strcmp(name, isaNames[level]) == 0) {
+            kernels() = kernelsFor((isa_level)level);
+            return true;
+        }
+    }
+    return false;
+}
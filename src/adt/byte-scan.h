@@ -0,0 +1,104 @@
+/**
+ * File: byte-scan.h
+ * ---------------------------
+ * Internal header, not installed. Exports the low-level byte scanning kernels
+ * behind class string_ref: they work on a raw (pointer, length) pair, never
+ * read past length, and never allocate. Each kernel has a scalar version and
+ * SSE2/AVX2/AVX-512 versions; the best one supported by the running CPU is
+ * selected once (cpuid) and called through a function pointer afterwards.
+ */
+
+#ifndef BYTE_SCAN_H
+#define BYTE_SCAN_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace adt {
+namespace byte_scan {
+    /* largest size_t value, the same as string_ref::npos */
+    static const size_t npos = (size_t)-1;
+
+    /* Returns the index of the first byte equal to c in [s, s + n), else npos */
+    size_t find(const char *s, size_t n, char c);
+
+    /* Returns the index of the last byte equal to c in [s, s + n), else npos */
+    size_t rfind(const char *s, size_t n, char c);
+
+    /* Returns the number of bytes equal to c in [s, s + n) */
+    size_t count(const char *s, size_t n, char c);
+
+    /* Writes the positions of the bytes equal to c in [s, s + n) as a bitmap:
+     * bit j of out[k] is set iff s[64 * k + j] == c. out must have room for
+     * (n + 63) / 64 words; the bits past n are 0. */
+    void match_bitmap(const char *s, size_t n, char c, uint64_t *out);
+
+    /* Returns the index of the first occurrence of the needle [p, p + m) in
+     * [s, s + n), else npos. Candidates are filtered by comparing two needle
+     * bytes, p[a] and p[b], a vector at a time and then verified with memcmp,
+     * so it shines for short needles. Picking rare bytes for a and b keeps
+     * false candidates rare. Requires 2 <= m <= n and a < b < m. */
+    size_t find_substr(const char *s, size_t n, const char *p, size_t m,
+                       size_t a, size_t b);
+    inline size_t find_substr(const char *s, size_t n, const char *p, size_t m) {
+        return find_substr(s, n, p, m, 0, m - 1);
+    }
+
+    /* The same as find_substr(), but returns the index of the last occurrence;
+     * the vectors walk the haystack from its end. Requires 2 <= m <= n. */
+    size_t rfind_substr(const char *s, size_t n, const char *p, size_t m,
+                        size_t a, size_t b);
+    inline size_t rfind_substr(const char *s, size_t n, const char *p, size_t m) {
+        return rfind_substr(s, n, p, m, 0, m - 1);
+    }
+
+    /* Character classes with vectorized kernels; the ids are the same as
+     * adt::char_class's template arguments */
+    enum class_id { class_space = 0, class_digit = 1, class_alnum = 2 };
+
+    /* Returns the index of the first (find_class) or last (rfind_class) byte
+     * in [s, s + n) that is in the class cls (not in it if negate), else npos.
+     * Classes are ASCII only: space is " \t\n\v\f\r", digit is 0-9, alnum
+     * is 0-9, A-Z and a-z. */
+    size_t find_class(const char *s, size_t n, int cls, bool negate);
+    size_t rfind_class(const char *s, size_t n, int cls, bool negate);
+
+    /* Returns the index of the first (find_set) or last (rfind_set) byte in
+     * [s, s + n) that is in a byte set (not in it if negate), else npos. The
+     * set comes as the tables adt::char_set builds: bits is a 256-bit bitmap,
+     * and bit (h % 8) of nibbles[16 * (h / 8) + l] is set iff the byte whose
+     * high and low nibbles are h and l is in the set. The vector kernels look
+     * the bytes up in the nibble tables with PSHUFB, so the cost does not
+     * depend on the size of the set. */
+    size_t find_set(const char *s, size_t n, const uint64_t *bits,
+                    const unsigned char *nibbles, bool negate);
+    size_t rfind_set(const char *s, size_t n, const uint64_t *bits,
+                     const unsigned char *nibbles, bool negate);
+
+    /* Writes [src, src + n) to [dst, dst + n) with the ASCII letters converted
+     * to upper case (if upper) or lower case; other bytes are copied as they
+     * are. dst may be src (in place), but may not overlap it otherwise. */
+    void convert_case(char *dst, const char *src, size_t n, bool upper);
+
+    /* Returns the first index i < n at which a[i] and b[i] differ once ASCII
+     * letters are lower-cased, else npos */
+    size_t mismatch_insensitive(const char *a, const char *b, size_t n);
+
+    /* The same as find_substr(), but ASCII letters match regardless of their
+     * case. The candidates are filtered on the first and last needle bytes,
+     * both sides lower-cased a vector at a time. Requires 1 <= m <= n. */
+    size_t find_substr_insensitive(const char *s, size_t n, const char *p, size_t m);
+
+    /* Name of the instruction set the kernels were resolved to, e.g. "avx2".
+     * Useful for logging and benchmarks only. */
+    const char *isa_name();
+
+    /* Switches the kernels to those of the instruction set name ("scalar",
+     * "sse2", "avx2" or "avx512"), so that the tests can run each of them.
+     * Returns false, changing nothing, if the CPU lacks it. Not thread-safe:
+     * no other thread may be scanning meanwhile. */
+    bool set_isa(const char *name);
+}
+}
+
+#endif
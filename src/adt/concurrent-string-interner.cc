@@ -0,0 +1,197 @@
+/**
+ * File: concurrent-string-interner.cc
+ * ---------------------------
+ * Implements class concurrent_string_interner.
+ * Memory ordering: an entry is fully written (in the shard's arena) before
+ * the release store that puts it in a table slot, and a table is fully built
+ * before the release store that makes it the shard's current one; readers
+ * load both with acquire, so they never see a partly written entry or table.
+ */
+
+#include "adt/concurrent-string-interner.h"
+#include "adt/hash-bytes.h"
+#include <stdexcept>
+
+const uint32_t adt::concurrent_string_interner::invalid_id;
+const size_t adt::concurrent_string_interner::firstSegment;
+const int adt::concurrent_string_interner::numSegments;
+
+namespace {
+    const size_t minTableSize = 64;
+}
+
+adt::concurrent_string_interner::table::table(size_t size)
+: mask(size - 1), slots(new std::atomic<const entry *>[size]) {
+    for (size_t i = 0; i != size; ++i) {
+        slots[i].store(nullptr, std::memory_order_relaxed);
+    }
+}
+
+adt::concurrent_string_interner::shard::shard() {
+    tables.emplace_back(new table(minTableSize));
+    current.store(tables.back().get(), std::memory_order_relaxed);
+}
+
+adt::concurrent_string_interner::concurrent_string_interner(size_t shard_count)
+: shardBits(0), nextId(0) {
+    while (((size_t)1 << shardBits) < shard_count && shardBits < 16) { ++shardBits; }
+    shards.reset(new shard[(size_t)1 << shardBits]);
+    for (int k = 0; k != numSegments; ++k) {
+        segments[k].store(nullptr, std::memory_order_relaxed);
+    }
+}
+
+adt::concurrent_string_interner::~concurrent_string_interner() {
+    for (int k = 0; k != numSegments; ++k) {
+        delete[] segments[k].load(std::memory_order_relaxed);
+    }
+}
+
+const adt::concurrent_string_interner::entry *
+adt::concurrent_string_interner::probe(const table *t, string_ref s, uint64_t hash) {
+    for (size_t i = (size_t)hash & t->mask;; i = (i + 1) & t->mask) {
+        const entry *e = t->slots[i].load(std::memory_order_acquire);
+        if (e == nullptr) { return nullptr; }
+        if (e->hash == hash && e->len == s.size()
+            && std::memcmp(e->chars(), s.ptr(), s.size()) == 0) { return e; }
+    }
+}
+
+const adt::concurrent_string_interner::entry *
+adt::concurrent_string_interner::insert(shard &sh, string_ref s, uint64_t hash) {
+    std::lock_guard<std::mutex> guard(sh.lock);
+    /* only this thread changes the shard now, but another one may have
+     * inserted s since the lock-free probe */
+    const table *t = sh.current.load(std::memory_order_relaxed);
+    if (const entry *e = probe(t, s, hash)) { return e; }
+
+    /* other shards take ids concurrently: never hands out invalid_id */
+    uint32_t id = nextId.load(std::memory_order_relaxed);
+    do {
+        if (id == invalid_id) {
+            throw std::length_error("concurrent_string_interner: too many strings");
+        }
+    } while (!nextId.compare_exchange_weak(id, id + 1, std::memory_order_relaxed));
+    entry *e = static_cast<entry *>(sh.pool.allocate(sizeof(entry) + s.size() + 1,
+                                                     alignof(entry)));
+    e->hash = hash;
+    e->len = (uint32_t)s.size();
+    e->id = id;
+    char *chars = reinterpret_cast<char *>(e + 1);
+    if (!s.empty()) { std::memcpy(chars, s.ptr(), s.size()); }
+    chars[s.size()] = '\0';
+    sh.bytes += s.size();
+    allocateIdSlot(id)->store(e, std::memory_order_release);
+
+    size_t i = (size_t)hash & t->mask;
+    while (t->slots[i].load(std::memory_order_relaxed) != nullptr) { i = (i + 1) & t->mask; }
+    t->slots[i].store(e, std::memory_order_release);
+
+    if (++sh.used > (t->mask + 1) / 4 * 3) {
+        /* builds the larger table privately, then publishes it */
+        table *grown = new table((t->mask + 1) * 2);
+        sh.tables.emplace_back(grown);
+        for (size_t j = 0; j <= t->mask; ++j) {
+            const entry *old = t->slots[j].load(std::memory_order_relaxed);
+            if (old == nullptr) { continue; }
+            size_t k = (size_t)old->hash & grown->mask;
+            while (grown->slots[k].load(std::memory_order_relaxed) != nullptr) {
+                k = (k + 1) & grown->mask;
+            }
+            grown->slots[k].store(old, std::memory_order_relaxed);
+        }
+        sh.current.store(grown, std::memory_order_release);
+    }
+    return e;
+}
+
+const adt::concurrent_string_interner::entry *
+adt::concurrent_string_interner::findOrInsert(string_ref s) {
+    /* the entries store the length in 32 bits */
+    if (s.size() >= UINT32_MAX) {
+        throw std::length_error("concurrent_string_interner: string too long");
+    }
+    uint64_t hash = hash_bytes(s.ptr(), s.size());
+    shard &sh = shardOf(hash);
+    const entry *e = probe(sh.current.load(std::memory_order_acquire), s, hash);
+    return e != nullptr ? e : insert(sh, s, hash);
+}
+
+adt::string_ref adt::concurrent_string_interner::intern(string_ref s) {
+    return findOrInsert(s)->str();
+}
+
+uint32_t adt::concurrent_string_interner::intern_id(string_ref s) {
+    return findOrInsert(s)->id;
+}
+
+uint32_t adt::concurrent_string_interner::find_id(string_ref s) const {
+    uint64_t hash = hash_bytes(s.ptr(), s.size());
+    const entry *e = probe(shardOf(hash).current.load(std::memory_order_acquire), s, hash);
+    return e == nullptr ? invalid_id : e->id;
+}
+
+adt::string_ref adt::concurrent_string_interner::operator[](uint32_t id) const {
+    std::atomic<const entry *> *slot = idSlot(id);
+    const entry *e = slot ? slot->load(std::memory_order_acquire) : nullptr;
+    assert(e != nullptr && "Out of range: invalid string id.");
+    return e->str();
+}
+
+namespace {
+    /* segment k holds the ids [firstSegment * (2^k - 1), firstSegment * (2^(k+1) - 1)) */
+    inline int segmentOf(uint32_t id, size_t firstSegment, size_t &offset) {
+        int k = 63 - __builtin_clzll(id / firstSegment + 1);
+        offset = id - firstSegment * (((size_t)1 << k) - 1);
+        return k;
+    }
+}
+
+std::atomic<const adt::concurrent_string_interner::entry *> *
+adt::concurrent_string_interner::idSlot(uint32_t id) const {
+    size_t offset;
+    int k = segmentOf(id, firstSegment, offset);
+    std::atomic<const entry *> *segment = segments[k].load(std::memory_order_acquire);
+    return segment ? segment + offset : nullptr;
+}
+
+std::atomic<const adt::concurrent_string_interner::entry *> *
+adt::concurrent_string_interner::allocateIdSlot(uint32_t id) {
+    size_t offset;
+    int k = segmentOf(id, firstSegment, offset);
+    std::atomic<const entry *> *segment = segments[k].load(std::memory_order_acquire);
+    if (segment == nullptr) {
+        /* rare (numSegments times at most), so one lock for all shards */
+        std::lock_guard<std::mutex> guard(segmentLock);
+        segment = segments[k].load(std::memory_order_relaxed);
+        if (segment == nullptr) {
+            size_t size = firstSegment << k;
+            segment = new std::atomic<const entry *>[size];
+            for (size_t i = 0; i != size; ++i) {
+                segment[i].store(nullptr, std::memory_order_relaxed);
+            }
+            segments[k].store(segment, std::memory_order_release);
+        }
+    }
+    return segment + offset;
+}
+
+adt::concurrent_string_interner::statistics
+adt::concurrent_string_interner::stats() const {
+    statistics st = { size(), 0, 0, 0 };
+    for (size_t i = 0; i != ((size_t)1 << shardBits); ++i) {
+        shard &sh = shards[i];
+        std::lock_guard<std::mutex> guard(sh.lock);
+        st.unique_bytes += sh.bytes;
+        st.arena_bytes += sh.pool.bytes_reserved();
+        for (const std::unique_ptr<table> &t : sh.tables) {
+            st.table_bytes += (t->mask + 1) * sizeof(std::atomic<const entry *>);
+        }
+    }
+    for (int k = 0; k != numSegments; ++k) {
+        if (segments[k].load(std::memory_order_acquire) != nullptr) {
+            st.table_bytes += (firstSegment << k) * sizeof(std::atomic<const entry *>);
+        }
+    }
+    return st;
+}
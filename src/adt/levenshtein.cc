@@ -0,0 +1,180 @@
+/**
+ * File: levenshtein.cc
+ * ---------------------------
+ * Implements the edit distance kernels declared in levenshtein.h.
+ */
+
+#include "levenshtein.h"
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include <algorithm> /* std::min(), std::swap() */
+
+namespace {
+
+inline bool isAsciiLetter(unsigned char c) {
+    return (c | 0x20) >= 'a' && (c | 0x20) <= 'z';
+}
+
+inline bool sameChar(char x, char y, bool case_sensitive) {
+    if (x == y) { return true; }
+    return !case_sensitive && (x ^ y) == 0x20 && isAsciiLetter(x);
+}
+
+/* Sets bit i of peq[c] for every position i of character c in [p, p + m),
+ * for both cases of a letter if case-insensitive. m <= 64 */
+void fillPeq(uint64_t *peq, const char *p, size_t m, bool case_sensitive) {
+    for (size_t i = 0; i != m; ++i) {
+        unsigned char c = p[i];
+        peq[c] |= (uint64_t)1 << i;
+        if (!case_sensitive && isAsciiLetter(c)) { peq[c ^ 0x20] |= (uint64_t)1 << i; }
+    }
+}
+
+/**
+ * Advances one 64-row block of the DP matrix by one column, Hyyro's way.
+ * The block's vertical deltas are encoded in pv (+1 rows) and mv (-1 rows);
+ * eq marks the rows whose pattern character equals the column's character.
+ * hin is the horizontal delta entering the block's top row (+1, 0 or -1), and
+ * the delta leaving the row marked by high is returned.
+ */
+inline int advanceBlock(uint64_t &pv, uint64_t &mv, uint64_t eq, int hin,
+                        uint64_t high) {
+    uint64_t xv = eq | mv;
+    if (hin < 0) { eq |= 1; }
+    uint64_t xh = (((eq & pv) + pv) ^ pv) | eq;
+    uint64_t ph = mv | ~(xh | pv);
+    uint64_t mh = pv & xh;
+    int hout = (ph & high) ? 1 : (mh & high) ? -1 : 0;
+    ph <<= 1;
+    mh <<= 1;
+    if (hin < 0) { mh |= 1; } else if (hin > 0) { ph |= 1; }
+    pv = mh | ~(xv | ph);
+    mv = ph & xv;
+    return hout;
+}
+
+/* One block, the whole state on the stack. 1 <= m <= 64 */
+size_t distanceShort(const char *p, size_t m, const char *t, size_t n,
+                     bool case_sensitive) {
+    uint64_t peq[256];
+    std::memset(peq, 0, sizeof(peq));
+    fillPeq(peq, p, m, case_sensitive);
+    const uint64_t high = (uint64_t)1 << (m - 1);
+    uint64_t pv = ~(uint64_t)0, mv = 0;
+    size_t score = m;
+    for (size_t j = 0; j != n; ++j) {
+        score += advanceBlock(pv, mv, peq[(unsigned char)t[j]], 1, high);
+    }
+    return score;
+}
+
+/* ceil(m / 64) blocks, each one's carry feeding the next one. m > 64 */
+size_t distanceLong(const char *p, size_t m, const char *t, size_t n,
+                    bool case_sensitive) {
+    const size_t blocks = (m + 63) / 64;
+    std::vector<uint64_t> peq(blocks * 256, 0);
+    for (size_t b = 0; b != blocks; ++b) {
+        fillPeq(&peq[b * 256], p + b * 64, std::min<size_t>(64, m - b * 64),
+                case_sensitive);
+    }
+    const uint64_t high = (uint64_t)1 << ((m - 1) % 64);
+    const uint64_t blockHigh = (uint64_t)1 << 63;
+    std::vector<uint64_t> pv(blocks, ~(uint64_t)0), mv(blocks, 0);
+    size_t score = m;
+    for (size_t j = 0; j != n; ++j) {
+        const unsigned char c = t[j];
+        int carry = 1;
+        for (size_t b = 0; b + 1 < blocks; ++b) {
+            carry = advanceBlock(pv[b], mv[b], peq[b * 256 + c], carry, blockHigh);
+        }
+        score += advanceBlock(pv[blocks - 1], mv[blocks - 1],
+                              peq[(blocks - 1) * 256 + c], carry, high);
+    }
+    return score;
+}
+
+/* The common prefix and suffix do not change the distance, strip them.
+ * Afterwards [a, a + m) is the shorter string. */
+void trimCommon(const char *&a, size_t &m, const char *&b, size_t &n,
+                bool case_sensitive) {
+    while (m > 0 && n > 0 && sameChar(a[0], b[0], case_sensitive)) {
+        ++a; ++b; --m; --n;
+    }
+    while (m > 0 && n > 0 && sameChar(a[m - 1], b[n - 1], case_sensitive)) {
+        --m; --n;
+    }
+    if (m > n) {
+        std::swap(a, b);
+        std::swap(m, n);
+    }
+}
+
+/**
+ * Ukkonen's banded DP. Row i keeps the cells D[i][j] for j in [i - k, i + k]
+ * at indices j - i + k, so D[i-1][j-1] is at the same index in the previous
+ * row and D[i-1][j] one index further; cells off the matrix or above k are
+ * saturated at k + 1. 1 <= m <= n, n - m <= k < n
+ */
+bool withinBand(const char *a, size_t m, const char *b, size_t n, size_t k,
+                bool case_sensitive) {
+    const size_t width = 2 * k + 1, over = k + 1;
+    size_t stackRows[2][65];
+    std::vector<size_t> heapRows;
+    size_t *prev = stackRows[0], *cur = stackRows[1];
+    if (width > 65) {
+        heapRows.resize(2 * width);
+        prev = heapRows.data();
+        cur = prev + width;
+    }
+    for (size_t idx = 0; idx != width; ++idx) { /* row 0: D[0][j] = j */
+        prev[idx] = idx < k ? over : idx - k;
+    }
+    for (size_t i = 1; i <= m; ++i) {
+        size_t rowMin = over;
+        for (size_t idx = 0; idx != width; ++idx) {
+            size_t val = over;
+            if (idx + i >= k && idx + i - k <= n) { /* j = i + idx - k */
+                size_t j = idx + i - k;
+                if (j == 0) {
+                    val = std::min(i, over);
+                } else {
+                    val = prev[idx] + !sameChar(a[i - 1], b[j - 1], case_sensitive);
+                    if (idx + 1 != width) { val = std::min(val, prev[idx + 1] + 1); }
+                    if (idx != 0) { val = std::min(val, cur[idx - 1] + 1); }
+                    val = std::min(val, over);
+                }
+            }
+            cur[idx] = val;
+            rowMin = std::min(rowMin, val);
+        }
+        if (rowMin > k) { return false; } /* diagonals never decrease */
+        std::swap(prev, cur);
+    }
+    return prev[n - m + k] <= k;
+}
+
+} /* namespace */
+
+size_t adt::levenshtein::distance(const char *a, size_t m, const char *b, size_t n,
+                                  bool case_sensitive) {
+    trimCommon(a, m, b, n, case_sensitive);
+    if (m == 0) { return n; }
+    /* the shorter string goes into the bit vectors */
+    return m <= 64 ? distanceShort(a, m, b, n, case_sensitive)
+                   : distanceLong(a, m, b, n, case_sensitive);
+}
+
+bool adt::levenshtein::within(const char *a, size_t m, const char *b, size_t n,
+                              size_t k, bool case_sensitive) {
+    trimCommon(a, m, b, n, case_sensitive);
+    if (n - m > k) { return false; } /* each extra character costs 1 */
+    if (m == 0 || k >= n) { return true; }  /* the distance is at most n */
+    /* a band wider than the bit vectors, one word per 64 rows, costs more
+     * per column than the full bit-parallel distance */
+    if (2 * k + 1 > 64 * ((m + 63) / 64)) {
+        return (m <= 64 ? distanceShort(a, m, b, n, case_sensitive)
+                        : distanceLong(a, m, b, n, case_sensitive)) <= k;
+    }
+    return withinBand(a, m, b, n, k, case_sensitive);
+}
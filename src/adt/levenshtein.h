@@ -0,0 +1,34 @@
+/**
+ * File: levenshtein.h
+ * ---------------------------
+ * Internal header, not installed. Exports the Levenshtein (edit) distance
+ * kernels behind string_ref::edit_distance(), working on (pointer, length)
+ * pairs. Case-insensitive comparisons fold ASCII letters only.
+ */
+
+#ifndef LEVENSHTEIN_H
+#define LEVENSHTEIN_H
+
+#include <cstddef>
+
+namespace adt {
+namespace levenshtein {
+    /* Returns the edit distance between [a, a + m) and [b, b + n), using the
+     * bit-parallel algorithm of Myers (in Hyyro's formulation): one 64-bit
+     * word per 64 characters of the shorter string, updated with a handful
+     * of bitwise operations per character of the longer one. Strings of up
+     * to 64 characters (after stripping the common prefix and suffix) need
+     * no heap allocation. */
+    size_t distance(const char *a, size_t m, const char *b, size_t n,
+                    bool case_sensitive);
+
+    /* Checks if the edit distance between [a, a + m) and [b, b + n) is at
+     * most k. Only the 2k+1 diagonals around the main one are computed
+     * (Ukkonen's band), the length difference is checked first, and the
+     * computation stops as soon as a whole row of the band exceeds k. */
+    bool within(const char *a, size_t m, const char *b, size_t n, size_t k,
+                bool case_sensitive);
+}
+}
+
+#endif
@@ -0,0 +1,48 @@
+/**
+ * File: line-index.cc
+ * ---------------------------
+ * Implements class line_index.
+ */
+
+#include "adt/line-index.h"
+#include "byte-scan.h"
+#include <algorithm>
+
+adt::line_index::line_index(string_ref text)
+: str(text), bits((text.size() + 63) / 64), countBefore(bits.size()) {
+    byte_scan::match_bitmap(text.ptr(), text.size(), '\n', bits.data());
+    size_t count = 0;
+    for (size_t k = 0; k != bits.size(); ++k) {
+        countBefore[k] = count;
+        count += __builtin_popcountll(bits[k]);
+    }
+    numNewlines = count;
+    /* a last line without its '\n' counts too */
+    numLines = count + (!text.empty() && text.back() != '\n');
+}
+
+size_t adt::line_index::select(size_t i) const {
+    /* the block holding it is the last one with fewer '\n's before it */
+    size_t k = std::upper_bound(countBefore.begin(), countBefore.end(), i)
+               - countBefore.begin() - 1;
+    uint64_t word = bits[k];
+    for (size_t skip = i - countBefore[k]; skip != 0; --skip) {
+        word &= word - 1;
+    }
+    return k * 64 + __builtin_ctzll(word);
+}
+
+adt::string_ref adt::line_index::line(size_t i) const {
+    assert(i < numLines && "Out of range: invalid line number.");
+    size_t start = i == 0 ? 0 : select(i - 1) + 1;
+    if (i == numNewlines) { return str.substr(start); } /* no '\n' at the end */
+    return lineEndingAt(start, select(i));
+}
+
+size_t adt::line_index::line_of(size_t offset) const {
+    assert(offset < str.size() && "Out of range: invalid offset.");
+    size_t k = offset / 64;
+    /* the '\n's strictly before offset */
+    uint64_t before = bits[k] & (((uint64_t)1 << (offset % 64)) - 1);
+    return countBefore[k] + __builtin_popcountll(before);
+}
@@ -0,0 +1,89 @@
+/**
+ * File: mapped-file.cc
+ * ---------------------------
+ * Implements class mapped_file.
+ */
+
+#include "adt/mapped-file.h"
+#include <cerrno>
+#include <string>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+adt::mapped_file::mapped_file(mapped_file &&other)
+: ps(other.ps), len(other.len), mapped(other.mapped), err(other.err) {
+    other.ps = nullptr;
+    other.len = 0;
+    other.mapped = false;
+}
+
+adt::mapped_file &adt::mapped_file::operator=(mapped_file &&other) {
+    if (this != &other) {
+        close();
+        ps = other.ps;
+        len = other.len;
+        mapped = other.mapped;
+        err = other.err;
+        other.ps = nullptr;
+        other.len = 0;
+        other.mapped = false;
+    }
+    return *this;
+}
+
+bool adt::mapped_file::open(string_ref path, unsigned advice) {
+    close();
+    const std::string name = path.to_string();  /* open() needs the '\0' */
+    int fd = ::open(name.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        err = errno;
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        err = errno;
+        ::close(fd);
+        return false;
+    }
+    err = 0;
+    if (st.st_size == 0) {
+        /* mmap() rejects a length of 0 */
+        ps = "";
+        len = 0;
+        ::close(fd);
+        return true;
+    }
+    void *p = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd); /* the mapping keeps the file open */
+    if (p == MAP_FAILED) {
+        err = errno;
+        return false;
+    }
+    ps = static_cast<const char *>(p);
+    len = (size_t)st.st_size;
+    mapped = true;
+    if (advice != normal) { advise(advice); }  /* a new mapping is normal */
+    return true;
+}
+
+void adt::mapped_file::close() {
+    if (mapped) { munmap(const_cast<char *>(ps), len); }
+    ps = nullptr;
+    len = 0;
+    mapped = false;
+}
+
+void adt::mapped_file::advise(unsigned advice) {
+    if (!mapped) { return; }
+    void *p = const_cast<char *>(ps);
+    /* hints only: a kernel that does not know one is no reason to fail */
+    if (advice == normal) { madvise(p, len, MADV_NORMAL); }
+    if (advice & sequential) { madvise(p, len, MADV_SEQUENTIAL); }
+    if (advice & random) { madvise(p, len, MADV_RANDOM); }
+    if (advice & willneed) { madvise(p, len, MADV_WILLNEED); }
+#ifdef MADV_HUGEPAGE
+    if (advice & huge_pages) { madvise(p, len, MADV_HUGEPAGE); }
+#endif
+}
@@ -0,0 +1,143 @@
+/**
+ * File: multi-pattern-matcher.cc
+ * ---------------------------
+ * Implements class multi_pattern_matcher.
+ */
+
+#include "adt/multi-pattern-matcher.h"
+#include <algorithm> /* std::sort() */
+#include <cstring>
+#include <stdexcept>
+
+namespace {
+
+/* Counts the trie's states, the distinct non-empty prefixes of the patterns
+ * (their bytes read as classes) plus the root, without building it: in sorted
+ * order, a pattern adds the bytes past its common prefix with the previous one */
+uint64_t countStates(const std::vector<adt::string_ref> &patterns, const uint16_t *classOf) {
+    auto classAt = [classOf](adt::string_ref s, size_t i) { return classOf[(unsigned char)s[i]]; };
+    std::vector<adt::string_ref> sorted(patterns);
+    std::sort(sorted.begin(), sorted.end(), [&](adt::string_ref a, adt::string_ref b) {
+        size_t i = 0, len = std::min(a.size(), b.size());
+        while (i != len && classAt(a, i) == classAt(b, i)) { ++i; }
+        return i == len ? a.size() < b.size() : classAt(a, i) < classAt(b, i);
+    });
+    uint64_t count = 1;
+    adt::string_ref prev;
+    for (adt::string_ref s : sorted) {
+        size_t common = 0, len = std::min(prev.size(), s.size());
+        while (common != len && classAt(prev, common) == classAt(s, common)) { ++common; }
+        count += s.size() - common;
+        prev = s;
+    }
+    return count;
+}
+
+}
+
+const uint32_t adt::multi_pattern_matcher::hasOutput;
+const uint32_t adt::multi_pattern_matcher::noState;
+
+adt::multi_pattern_matcher::multi_pattern_matcher(
+    const std::vector<string_ref> &patterns, bool case_sensitive)
+: numClasses(1) {
+    /* byte classes: column 0 is shared by the bytes absent from all patterns,
+     * and the two cases of a letter share a column if case-insensitive */
+    std::memset(classOf, 0, sizeof(classOf));
+    for (string_ref pattern : patterns) {
+        for (char ch : pattern) {
+            unsigned char c = ch;
+            if (classOf[c] != 0) { continue; }
+            classOf[c] = (uint16_t)numClasses++;
+            if (!case_sensitive && ((c | 0x20) >= 'a' && (c | 0x20) <= 'z')) {
+                classOf[c ^ 0x20] = classOf[c];
+            }
+        }
+    }
+
+    /* the trie has at most one state per pattern byte, plus the root; the
+     * table's row offsets must stay below the hasOutput bit */
+    uint64_t maxStates = 1;
+    for (string_ref pattern : patterns) { maxStates += pattern.size(); }
+    if (maxStates * numClasses >= hasOutput &&
+        countStates(patterns, classOf) * numClasses >= hasOutput) {
+        throw std::length_error("multi_pattern_matcher: too many states");
+    }
+
+    /* trie, with noState for the missing edges */
+    transitions.assign(numClasses, noState);
+    std::vector<std::vector<uint32_t> > stateIds(1);
+    for (size_t id = 0; id != patterns.size(); ++id) {
+        patternLens.push_back(patterns[id].size());
+        if (patterns[id].empty()) { continue; }
+        uint32_t state = 0;
+        for (char ch : patterns[id]) {
+            size_t edge = (size_t)state * numClasses + classOf[(unsigned char)ch];
+            if (transitions[edge] == noState) {
+                transitions[edge] = (uint32_t)stateIds.size();
+                stateIds.emplace_back();
+                transitions.resize(transitions.size() + numClasses, noState);
+            }
+            state = transitions[edge];
+        }
+        stateIds[state].push_back((uint32_t)id);
+    }
+    const size_t numStates = stateIds.size();
+
+    /* failure links in BFS order (a state's failure state is shallower, so it
+     * is complete when needed), turning the trie into a full DFA */
+    std::vector<uint32_t> fail(numStates, 0), queue;
+    dictLink.assign(numStates, noState);
+    queue.reserve(numStates);
+    for (uint32_t c = 0; c != numClasses; ++c) {
+        uint32_t &next = transitions[c];
+        if (next == noState) { next = 0; }
+        else { queue.push_back(next); }
+    }
+    for (size_t head = 0; head != queue.size(); ++head) {
+        uint32_t state = queue[head];
+        uint32_t *row = &transitions[(size_t)state * numClasses];
+        const uint32_t *failRow = &transitions[(size_t)fail[state] * numClasses];
+        for (uint32_t c = 0; c != numClasses; ++c) {
+            if (row[c] == noState) {
+                row[c] = failRow[c];
+                continue;
+            }
+            uint32_t next = row[c], suffix = failRow[c];
+            fail[next] = suffix;
+            dictLink[next] = stateIds[suffix].empty() ? dictLink[suffix] : suffix;
+            queue.push_back(next);
+        }
+    }
+
+    /* flattened pattern lists, and transitions as row offsets plus flag */
+    ownFirst.reserve(numStates + 1);
+    for (size_t state = 0; state != numStates; ++state) {
+        ownFirst.push_back((uint32_t)ownIds.size());
+        ownIds.insert(ownIds.end(), stateIds[state].begin(), stateIds[state].end());
+    }
+    ownFirst.push_back((uint32_t)ownIds.size());
+    for (uint32_t &next : transitions) {
+        bool reports = !stateIds[next].empty() || dictLink[next] != noState;
+        next = next * numClasses | (reports ? hasOutput : 0);
+    }
+}
+
+std::vector<adt::multi_pattern_matcher::match>
+adt::multi_pattern_matcher::find_all(string_ref haystack) const {
+    std::vector<match> found;
+    scan(haystack, [&found](const match &m) {
+        found.push_back(m);
+        return true;
+    });
+    return found;
+}
+
+bool adt::multi_pattern_matcher::contains_any(string_ref haystack) const {
+    bool found = false;
+    scan(haystack, [&found](const match &) {
+        found = true;
+        return false;
+    });
+    return found;
+}
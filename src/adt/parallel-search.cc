@@ -0,0 +1,118 @@
+/**
+ * File: parallel-search.cc
+ * ---------------------------
+ * Implements the parallel searches. Chunk k covers the match starts in
+ * [k * chunk_size, (k + 1) * chunk_size) and is searched in the window that
+ * extends pattern.size() - 1 bytes further, so that a match it owns is
+ * entirely in the window while a match owned by the next chunk is not.
+ */
+
+#include "adt/parallel-search.h"
+#include "adt/string-searcher.h"
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <vector>
+
+namespace {
+
+size_t numChunks(size_t n, size_t chunk_size) {
+    return (n + chunk_size - 1) / chunk_size;
+}
+
+/* The window of the matches starting in [0, end), positions being the text's */
+adt::string_ref windowUpTo(adt::string_ref text, size_t end, size_t m) {
+    return text.substr(0, std::min(end + m - 1, text.size()));
+}
+
+/* Counts the non-overlapping matches found by a greedy scan from entry that
+ * start before end; next is where the scan resumes after them, at end or
+ * inside the last match if it straddles end */
+size_t countGreedy(const adt::string_ref_searcher &searcher, adt::string_ref text,
+                   size_t entry, size_t end, size_t &next) {
+    const size_t m = searcher.pattern().size();
+    adt::string_ref window = windowUpTo(text, end, m);
+    size_t found = 0, resume = entry, pos;
+    while (resume < end && (pos = searcher.find(window, resume)) != adt::string_ref::npos) {
+        ++found;
+        resume = pos + m;
+    }
+    next = std::max(resume, end);
+    return found;
+}
+
+}
+
+size_t adt::parallel_count_char(adt::string_ref text, char c, adt::thread_pool &pool,
+                                size_t chunk_size) {
+    assert(chunk_size > 0);
+    if (text.size() <= chunk_size) { return text.count_char(c); }
+    std::vector<size_t> partial(numChunks(text.size(), chunk_size));
+    pool.parallel_for(partial.size(), [&](size_t k) {
+        partial[k] = text.substr(k * chunk_size, chunk_size).count_char(c);
+    });
+    size_t total = 0;
+    for (size_t found : partial) { total += found; }
+    return total;
+}
+
+size_t adt::parallel_count_str(adt::string_ref text, adt::string_ref pattern,
+                               bool overlapping, adt::thread_pool &pool,
+                               size_t chunk_size) {
+    assert(chunk_size > 0);
+    if (text.size() <= chunk_size || pattern.empty()) {
+        return text.count_str(pattern, overlapping);
+    }
+    const string_ref_searcher searcher(pattern);
+    const size_t m = pattern.size();
+    const size_t chunks = numChunks(text.size(), chunk_size);
+    std::vector<size_t> partial(chunks), exits(chunks);
+    pool.parallel_for(chunks, [&](size_t k) {
+        const size_t start = k * chunk_size;
+        const size_t end = std::min(start + chunk_size, text.size());
+        if (overlapping) { /* linear, KMP: a periodic text does not rescan */
+            partial[k] = searcher.count(windowUpTo(text, end, m).substr(start));
+        } else {
+            partial[k] = countGreedy(searcher, text, start, end, exits[k]);
+        }
+    });
+    size_t total = 0;
+    if (overlapping) {
+        for (size_t found : partial) { total += found; }
+        return total;
+    }
+    /* Each chunk was scanned as if no match spilled into it. Where one did,
+     * the greedy scan really enters the chunk later: redo it from there. */
+    size_t entry = 0;
+    for (size_t k = 0; k != chunks; ++k) {
+        const size_t start = k * chunk_size;
+        const size_t end = std::min(start + chunk_size, text.size());
+        if (entry == start) {
+            total += partial[k];
+            entry = exits[k];
+        } else if (entry < end) {
+            total += countGreedy(searcher, text, entry, end, entry);
+        }
+    }
+    return total;
+}
+
+size_t adt::parallel_find_str(adt::string_ref text, adt::string_ref pattern,
+                              adt::thread_pool &pool, size_t chunk_size) {
+    assert(chunk_size > 0);
+    if (text.size() <= chunk_size || pattern.empty()) { return text.find_str(pattern); }
+    const string_ref_searcher searcher(pattern);
+    const size_t m = pattern.size();
+    /* the first match found so far; chunks after it are skipped */
+    std::atomic<size_t> first(string_ref::npos);
+    pool.parallel_for(numChunks(text.size(), chunk_size), [&](size_t k) {
+        const size_t start = k * chunk_size;
+        if (start >= first.load(std::memory_order_relaxed)) { return; }
+        const size_t end = std::min(start + chunk_size, text.size());
+        size_t pos = searcher.find(windowUpTo(text, end, m), start);
+        if (pos == string_ref::npos) { return; }
+        size_t seen = first.load(std::memory_order_relaxed);
+        while (pos < seen && !first.compare_exchange_weak(seen, pos, std::memory_order_relaxed)) {}
+    });
+    return first.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,72 @@
+/**
+ * File: stream-matcher.cc
+ * ---------------------------
+ * Implements class stream_matcher.
+ */
+
+#include "adt/stream-matcher.h"
+#include <algorithm>
+#include <cstring>
+
+const size_t adt::stream_matcher::npos;
+
+namespace {
+    char *copyOf(adt::string_ref s) {
+        char *chars = new char[s.size() + 1];
+        std::memcpy(chars, s.ptr(), s.size());
+        chars[s.size()] = '\0';
+        return chars;
+    }
+}
+
+adt::stream_matcher::stream_matcher(string_ref pattern, bool overlapping)
+: chars(copyOf(pattern)), searcher(string_ref(chars.get(), pattern.size())),
+  overlapping(overlapping), matched(0), consumed(0) {}
+
+std::vector<size_t> adt::stream_matcher::feed(string_ref chunk) {
+    std::vector<size_t> offsets;
+    feed(chunk, [&](size_t offset) {
+        offsets.push_back(offset);
+        return true;
+    });
+    return offsets;
+}
+
+size_t adt::stream_matcher::nextMatchEnd(string_ref chunk, size_t &i) {
+    const char *s = chunk.ptr(), *p = chars.get();
+    const size_t *fail = searcher.fail.data();
+    const size_t n = chunk.size(), m = pattern().size();
+    if (m == 0) {
+        i = n;
+        return npos;
+    }
+    /* a partial match carried over: KMP steps until it completes or dies */
+    size_t k = matched;
+    while (k > 0 && i != n) {
+        while (k > 0 && s[i] != p[k]) { k = fail[k - 1]; }
+        if (s[i] == p[k]) { ++k; }
+        ++i;
+        if (k == m) {
+            matched = overlapping ? fail[m - 1] : 0;
+            return i;
+        }
+    }
+    if (k == 0 && i != n) {
+        /* nothing pending: the next occurrence starts at or after i, and
+         * the vectorized search finds it */
+        size_t pos = searcher.find(chunk, i);
+        if (pos != npos) {
+            i = pos + m;
+            matched = overlapping ? fail[m - 1] : 0;
+            return i;
+        }
+        /* none in the chunk: the new state is a prefix of the pattern
+         * shorter than m, so it starts in the chunk's last m - 1 bytes */
+        for (i = std::max(i, n - std::min(n, m - 1)); i != n; ++i) {
+            while (k > 0 && s[i] != p[k]) { k = fail[k - 1]; }
+            if (s[i] == p[k]) { ++k; }
+        }
+    }
+    matched = k;
+    return npos;
+}
@@ -0,0 +1,63 @@
+/**
+ * File: string-builder.cc
+ * ---------------------------
+ * Implements class string_builder.
+ */
+
+#include "adt/string-builder.h"
+#include <algorithm>
+
+void adt::string_builder::grow(size_t extra) {
+    /* doubles, so appending char by char is amortized O(1); one more byte
+     * for the '\0' of finish() */
+    size_t newCap = std::max(std::max(cap * 2, len + extra), (size_t)31);
+    if (data != nullptr && pool.try_resize(data, cap + 1, newCap + 1)) {
+        cap = newCap;
+        return;
+    }
+    /* something else was allocated after the string: move it */
+    char *moved = pool.allocate_chars(newCap + 1);
+    if (len != 0) { std::memcpy(moved, data, len); }
+    data = moved;
+    cap = newCap;
+}
+
+adt::string_ref adt::string_builder::finish() {
+    if (data == nullptr) { grow(0); }
+    data[len] = '\0';
+    pool.try_resize(data, cap + 1, len + 1);
+    string_ref built(data, len);
+    data = nullptr;
+    len = cap = 0;
+    return built;
+}
+
+adt::string_builder &adt::string_builder::append_int(unsigned long long value) {
+    /* two digits at a time, written backwards */
+    static const char pairs[] =
+        "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+        "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+        "8081828384858687888990919293949596979899";
+    char buf[20];
+    char *p = buf + sizeof(buf);
+    while (value >= 100) {
+        unsigned i = (unsigned)(value % 100) * 2;
+        value /= 100;
+        *--p = pairs[i + 1];
+        *--p = pairs[i];
+    }
+    if (value >= 10) {
+        *--p = pairs[value * 2 + 1];
+        *--p = pairs[value * 2];
+    } else {
+        *--p = (char)('0' + value);
+    }
+    return append(string_ref(p, buf + sizeof(buf) - p));
+}
+
+adt::string_builder &adt::string_builder::append_int(long long value) {
+    if (value >= 0) { return append_int((unsigned long long)value); }
+    append('-');
+    /* negates in unsigned arithmetic, which is fine for LLONG_MIN too */
+    return append_int(0ull - (unsigned long long)value);
+}
@@ -0,0 +1,86 @@
+/**
+ * File: string-interner.cc
+ * ---------------------------
+ * Implements class string_interner.
+ */
+
+#include "adt/string-interner.h"
+#include "adt/hash-bytes.h"
+#include <stdexcept>
+
+const uint32_t adt::string_interner::invalid_id;
+
+namespace {
+    const uint32_t emptyLen = UINT32_MAX;
+    const size_t minTableSize = 16;
+}
+
+adt::string_interner::string_interner(size_t expected_strings)
+: interns(0), duplicateBytes(0) {
+    /* keeps the load factor at most 3/4 until expected_strings */
+    size_t size = minTableSize;
+    while (size / 4 * 3 < expected_strings) { size *= 2; }
+    table.assign(size, slot{ 0, emptyLen, 0 });
+    strings.reserve(expected_strings);
+}
+
+size_t adt::string_interner::probe(string_ref s, uint64_t hash) const {
+    const size_t mask = table.size() - 1;
+    for (size_t i = (size_t)hash & mask;; i = (i + 1) & mask) {
+        const slot &e = table[i];
+        if (e.len == emptyLen) { return i; }
+        if (e.hash == hash && e.len == s.size()
+            && std::memcmp(strings[e.id].ptr(), s.ptr(), s.size()) == 0) { return i; }
+    }
+}
+
+uint32_t adt::string_interner::intern_id(string_ref s) {
+    /* emptyLen marks the free slots */
+    if (s.size() >= emptyLen) { throw std::length_error("string_interner: string too long"); }
+    ++interns;
+    uint64_t hash = hash_bytes(s.ptr(), s.size());
+    size_t i = probe(s, hash);
+    if (table[i].len != emptyLen) {
+        duplicateBytes += s.size();
+        return table[i].id;
+    }
+    if (strings.size() >= invalid_id) {
+        throw std::length_error("string_interner: too many strings");
+    }
+    uint32_t id = (uint32_t)strings.size();
+    strings.push_back(pool.copy(s));
+    table[i] = slot{ hash, (uint32_t)s.size(), id };
+    if (strings.size() > table.size() / 4 * 3) { grow(); }
+    return id;
+}
+
+uint32_t adt::string_interner::find_id(string_ref s) const {
+    if (s.size() >= emptyLen) { return invalid_id; }
+    const slot &e = table[probe(s, hash_bytes(s.ptr(), s.size()))];
+    return e.len == emptyLen ? invalid_id : e.id;
+}
+
+void adt::string_interner::grow() {
+    /* rehashes from the cached hashes, without touching the strings */
+    std::vector<slot> old(table.size() * 2, slot{ 0, emptyLen, 0 });
+    old.swap(table);
+    const size_t mask = table.size() - 1;
+    for (const slot &e : old) {
+        if (e.len == emptyLen) { continue; }
+        size_t i = (size_t)e.hash & mask;
+        while (table[i].len != emptyLen) { i = (i + 1) & mask; }
+        table[i] = e;
+    }
+}
+
+adt::string_interner::statistics adt::string_interner::stats() const {
+    statistics st;
+    st.strings = strings.size();
+    st.interns = interns;
+    st.unique_bytes = pool.bytes_used() - strings.size(); /* minus the '\0's */
+    st.duplicate_bytes = duplicateBytes;
+    st.arena_bytes = pool.bytes_reserved();
+    st.table_bytes = table.capacity() * sizeof(slot)
+                     + strings.capacity() * sizeof(string_ref);
+    return st;
+}
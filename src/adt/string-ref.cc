@@ -5,109 +5,160 @@
  */
 
 #include "adt/string-ref.h"
+#include "byte-scan.h"
+#include "string-search.h"
+#include "levenshtein.h"
 #include <iostream>
-#include <vector>
-#include <locale> /* std::tolower() */
 
-bool adt::string_ref::starts_with(string_ref prefix) const {
+/* definitions of the static members, needed when they are odr-used */
+const size_t adt::string_ref::npos;
+const size_t adt::string_ref::capacity;
+
+bool adt::string_ref::equals_insensitive(string_ref rhs) const {
+    return len == rhs.len
+           && byte_scan::mismatch_insensitive(ps, rhs.ps, len) == byte_scan::npos;
+}
+
+int adt::string_ref::compare_insensitive(string_ref rhs) const {
+    size_t pos = byte_scan::mismatch_insensitive(ps, rhs.ps, std::min(len, rhs.len));
+    if (pos != byte_scan::npos) {
+        unsigned char l = ps[pos], r = rhs.ps[pos];
+        l = (unsigned char)(l - 'A') < 26 ? l | 0x20 : l;
+        r = (unsigned char)(r - 'A') < 26 ? r | 0x20 : r;
+        return l < r ? -1 : 1;
+    }
+    if (len == rhs.len) { return 0; }
+    return len < rhs.len ? -1 : 1;
+}
+
+bool adt::string_ref::starts_with_insensitive(string_ref prefix) const {
     return prefix.len <= len
-           && memCompare(ps, prefix.ps, prefix.len) == 0;
+           && byte_scan::mismatch_insensitive(ps, prefix.ps, prefix.len) == byte_scan::npos;
 }
 
-bool adt::string_ref::ends_with(string_ref suffix) const {
-    return suffix.len <= len 
-           && memCompare(end() - suffix.len, suffix.ps, suffix.len) == 0;
+bool adt::string_ref::ends_with_insensitive(string_ref suffix) const {
+    return suffix.len <= len
+           && byte_scan::mismatch_insensitive(end() - suffix.len, suffix.ps,
+                                              suffix.len) == byte_scan::npos;
+}
+
+size_t adt::string_ref::find_insensitive(string_ref pattern, size_t start) const {
+    if (start > len) { return npos; }
+    if (pattern.len == 0) { return start; }
+    if (pattern.len > len - start) { return npos; }
+    size_t pos = byte_scan::find_substr_insensitive(ps + start, len - start,
+                                                    pattern.ps, pattern.len);
+    return pos == byte_scan::npos ? npos : start + pos;
 }
 
 size_t adt::string_ref::edit_distance(const string_ref rhs,
                                       bool case_sensitive) const {
-    const string_ref &s1 = *this;
-    const string_ref &s2 = rhs;
-    size_t len1 = s1.size(), len2 = s2.size();
-    if (len1 == 0 || len2 == 0) { return len1 + len2; }
-    std::vector<size_t> dp(len2 + 1, 0), dpPrev(len2 + 1, 0); /* dynamic programming */
-    for (size_t j = 1; j <= len2; j++) { dp[j] = j; }
-    for (size_t i = 1; i <= len1; i++) {
-        swap(dp, dpPrev); // O(1)
-        dp[0] = i;
-        for (size_t j = 1; j <= len2; j++) {
-            if (case_sensitive ? s1[i - 1] == s2[j - 1]
-                : std::tolower(s1[i - 1]) == std::tolower(s2[j - 1])) {
-                    dp[j] = dpPrev[j - 1];
-            }
-            else {
-                dp[j] = std::min(dpPrev[j - 1] + 1,
-                        std::min(dp[j - 1] + 1, dpPrev[j] + 1));
-            }
-        }
-    }
-    return dp[len2];
+    return levenshtein::distance(ps, len, rhs.ps, rhs.len, case_sensitive);
+}
+
+bool adt::string_ref::edit_distance_within(const string_ref rhs, size_t max_k,
+                                           bool case_sensitive) const {
+    return levenshtein::within(ps, len, rhs.ps, rhs.len, max_k, case_sensitive);
 }
 
 size_t adt::string_ref::find_char(char c, size_t start) const {
     if (start >= len) { return npos; }
-    for (size_t i = start; i < len; ++i) {
-        if (c == ps[i]) { return i; }
-    }
-    return npos;
+    size_t pos = byte_scan::find(ps + start, len - start, c);
+    return pos == byte_scan::npos ? npos : start + pos;
 }
 
 size_t adt::string_ref::rfind_char(char c, size_t rstart) const {
-    for (size_t i = std::min(rstart, len - 1); i >= 0; --i) {
-        if (c == ps[i]) { return i; }
-    }
-    return npos;
+    if (len == 0) { return npos; }
+    size_t pos = byte_scan::rfind(ps, std::min(rstart, len - 1) + 1, c);
+    return pos == byte_scan::npos ? npos : pos;
 }
 
 size_t adt::string_ref::find_str(adt::string_ref pattern) const {
-    if (pattern.size() == 0) { return 0; }
-    /* const char *strstr(const char *haystack, const char *needle) */
-    const char *found = std::strstr(ps, pattern.to_string().c_str());
-    if (!found) { return npos; }
-    return found - ps;
+    size_t pos = string_search::find(ps, len, pattern.ps, pattern.len);
+    return pos == string_search::npos ? npos : pos;
 }
 
 size_t adt::string_ref::rfind_str(adt::string_ref pattern) const {
-    if (pattern.size() == 0) { return 0; }
-    /* oh oh, I am lazy, so I turned to std::string. */
-    size_t pos = to_string().rfind(pattern.to_string());
-    if (pos == std::string::npos) { return npos; }
-    return pos;
-    /* Maybe I should implement using KMP algorithm, or brute-force?
-     * Usage for rfind() is rare enough to not care about its efficiency. */
+    size_t pos = string_search::rfind(ps, len, pattern.ps, pattern.len);
+    return pos == string_search::npos ? npos : pos;
 }
 
 size_t adt::string_ref::find_if(std::function<bool(char)> pred, size_t start) const {
-    if (start >= len) { return npos; }
-    for (size_t i = start, e = len; i != e; ++i) {
-        if (pred(ps[i])) { return i; }
-    }
-    return npos;
+    return findIf(pred, start, false);
 }
 
 size_t adt::string_ref::rfind_if(std::function<bool(char)> pred, size_t rstart) const {
-    for (size_t i = std::min(rstart, len - 1); i >= 0; --i) {
-        if (pred(ps[i])) { return i; }
-    }
-    return npos;
+    return rfindIf(pred, rstart, false);
+}
+
+size_t adt::string_ref::findClass(int id, size_t start, bool negate) const {
+    if (start >= len) { return npos; }
+    size_t pos = byte_scan::find_class(ps + start, len - start, id, negate);
+    return pos == byte_scan::npos ? npos : start + pos;
+}
+
+size_t adt::string_ref::rfindClass(int id, size_t rstart, bool negate) const {
+    if (len == 0) { return npos; }
+    size_t pos = byte_scan::rfind_class(ps, std::min(rstart, len - 1) + 1, id, negate);
+    return pos == byte_scan::npos ? npos : pos;
+}
+
+size_t adt::string_ref::findSet(const adt::char_set &chars, size_t start,
+                                bool negate) const {
+    if (start >= len) { return npos; }
+    size_t pos = byte_scan::find_set(ps + start, len - start, chars.bitmap(),
+                                     chars.nibble_table(), negate);
+    return pos == byte_scan::npos ? npos : start + pos;
+}
+
+size_t adt::string_ref::rfindSet(const adt::char_set &chars, size_t rstart,
+                                 bool negate) const {
+    if (len == 0) { return npos; }
+    size_t pos = byte_scan::rfind_set(ps, std::min(rstart, len - 1) + 1, chars.bitmap(),
+                                      chars.nibble_table(), negate);
+    return pos == byte_scan::npos ? npos : pos;
+}
+
+size_t adt::string_ref::find_first_of(adt::string_ref chars, size_t start) const {
+    if (chars.len == 1) { return find_char(chars.ps[0], start); }
+    return findSet(adt::char_set(chars), start, false);
+}
+
+size_t adt::string_ref::find_first_of(const adt::char_set &chars, size_t start) const {
+    return findSet(chars, start, false);
+}
+
+size_t adt::string_ref::find_first_not_of(adt::string_ref chars, size_t start) const {
+    return findSet(adt::char_set(chars), start, true);
+}
+
+size_t adt::string_ref::find_first_not_of(const adt::char_set &chars, size_t start) const {
+    return findSet(chars, start, true);
+}
+
+size_t adt::string_ref::find_last_of(adt::string_ref chars, size_t rstart) const {
+    if (chars.len == 1) { return rfind_char(chars.ps[0], rstart); }
+    return rfindSet(adt::char_set(chars), rstart, false);
+}
+
+size_t adt::string_ref::find_last_of(const adt::char_set &chars, size_t rstart) const {
+    return rfindSet(chars, rstart, false);
+}
+
+size_t adt::string_ref::find_last_not_of(adt::string_ref chars, size_t rstart) const {
+    return rfindSet(adt::char_set(chars), rstart, true);
+}
+
+size_t adt::string_ref::find_last_not_of(const adt::char_set &chars, size_t rstart) const {
+    return rfindSet(chars, rstart, true);
 }
 
 size_t adt::string_ref::count_char(char c) const {
-    size_t count = 0;
-    for (size_t i = 0, e = len; i != e; ++i) { /* plays with cache locality */
-        if (ps[i] == c) { ++count; }
-    }
-    return count;
+    return byte_scan::count(ps, len, c);
 }
 
-size_t adt::string_ref::count_str(adt::string_ref pattern) const {
-    size_t patternLen = pattern.len;
-    if (patternLen > len) { return 0; }
-    size_t count = 0;
-    for (size_t i = 0, e = len - patternLen + 1; i != e; ++i) {
-        if (substr(i, patternLen).equals(pattern)) { ++count; }
-    }
-    return count;
+size_t adt::string_ref::count_str(adt::string_ref pattern, bool overlapping) const {
+    return string_search::count(ps, len, pattern.ps, pattern.len, overlapping);
 }
 
 std::pair<adt::string_ref, adt::string_ref> adt::string_ref::split(char sep) const {
@@ -133,3 +184,19 @@ std::pair<adt::string_ref, adt::string_ref> adt::string_ref::rsplit(string_ref s
     return pos == npos ? std::make_pair(*this, string_ref())
                        : std::make_pair(slice(0, pos), slice(pos + sep.size(), len));
 }
+
+void adt::ascii_tolower(char *s, size_t len) {
+    byte_scan::convert_case(s, s, len, false);
+}
+
+void adt::ascii_toupper(char *s, size_t len) {
+    byte_scan::convert_case(s, s, len, true);
+}
+
+void adt::ascii_tolower(char *dst, adt::string_ref src) {
+    byte_scan::convert_case(dst, src.ptr(), src.size(), false);
+}
+
+void adt::ascii_toupper(char *dst, adt::string_ref src) {
+    byte_scan::convert_case(dst, src.ptr(), src.size(), true);
+}
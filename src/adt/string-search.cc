@@ -0,0 +1,181 @@
+/**
+ * File: string-search.cc
+ * ---------------------------
+ * Implements the substring search engine declared in string-search.h.
+ */
+
+#include "string-search.h"
+#include "byte-scan.h"
+#include <cstring>
+#include <vector>
+#include <algorithm> /* std::min(), std::swap() */
+
+namespace {
+
+/* Bytes roughly ordered from the most to the least frequent in text, logs and
+ * source code. Bytes not listed (control bytes, non-ASCII) are the rarest. */
+const char commonBytes[] =
+    " etaoinsrhldcumfpgwybvkxjqz\n0123456789.,/:-_=\"ETAOINSRHLDCUMFPGWYBVKXJQZ"
+    "()'\t;<>[]{}*#+&%$@!?|\\~`^";
+
+/* rank of every byte: 0 for the rarest ones, larger for more frequent ones */
+struct rank_table {
+    unsigned char rank[256];
+    rank_table() {
+        std::memset(rank, 0, sizeof(rank));
+        const size_t num = sizeof(commonBytes) - 1;
+        for (size_t i = 0; i != num; ++i) {
+            rank[(unsigned char)commonBytes[i]] = (unsigned char)(num - i);
+        }
+    }
+};
+
+const rank_table &ranks() {
+    static const rank_table table;
+    return table;
+}
+
+} /* namespace */
+
+void adt::string_search::pick_rare_pair(const char *p, size_t m, size_t &a, size_t &b) {
+    const unsigned char *rank = ranks().rank;
+    a = 0;
+    for (size_t i = 1; i != m; ++i) {
+        if (rank[(unsigned char)p[i]] < rank[(unsigned char)p[a]]) { a = i; }
+    }
+    /* the second byte must differ from the first one, or the filter would
+     * degenerate into a single-byte filter */
+    b = npos;
+    for (size_t i = 0; i != m; ++i) {
+        if (p[i] == p[a]) { continue; }
+        if (b == npos || rank[(unsigned char)p[i]] < rank[(unsigned char)p[b]]) { b = i; }
+    }
+    if (b == npos) { b = (a == m - 1) ? 0 : m - 1; } /* all bytes are the same */
+    if (a > b) { std::swap(a, b); }
+}
+
+/* Shifts longer than UINT32_MAX are clamped, which is shorter than they
+ * could be, yet still safe. */
+
+void adt::string_search::build_shifts(const char *p, size_t m, uint32_t *shift) {
+    const uint32_t maxShift = (uint32_t)std::min<size_t>(m, UINT32_MAX);
+    for (size_t c = 0; c != 256; ++c) { shift[c] = maxShift; }
+    for (size_t i = 0; i + 1 < m; ++i) {
+        shift[(unsigned char)p[i]] = (uint32_t)std::min<size_t>(m - 1 - i, UINT32_MAX);
+    }
+}
+
+void adt::string_search::build_rshifts(const char *p, size_t m, uint32_t *rshift) {
+    const uint32_t maxShift = (uint32_t)std::min<size_t>(m, UINT32_MAX);
+    for (size_t c = 0; c != 256; ++c) { rshift[c] = maxShift; }
+    for (size_t i = m - 1; i != 0; --i) {
+        rshift[(unsigned char)p[i]] = (uint32_t)std::min<size_t>(i, UINT32_MAX);
+    }
+}
+
+/* Boyer-Moore-Horspool: on a mismatch, shifts the window by the distance
+ * between the byte under the window's last position and its last occurrence
+ * in the needle (excluding the needle's last byte). */
+size_t adt::string_search::find_horspool(const char *s, size_t n, const char *p,
+                                         size_t m, const uint32_t *shift) {
+    if (m > n) { return npos; }
+    const unsigned char last = p[m - 1];
+    for (size_t i = 0; i <= n - m; ) {
+        unsigned char c = s[i + m - 1];
+        if (c == last && std::memcmp(s + i, p, m - 1) == 0) { return i; }
+        i += shift[c];
+    }
+    return npos;
+}
+
+/* Horspool mirrored: the window moves leftwards and is aligned on the byte
+ * under its first position, with the shift being the distance to that byte's
+ * first occurrence in the needle (excluding the needle's first byte). */
+size_t adt::string_search::rfind_horspool(const char *s, size_t n, const char *p,
+                                          size_t m, const uint32_t *rshift) {
+    if (m > n) { return npos; }
+    const unsigned char first = p[0];
+    for (size_t i = n - m; ; ) {
+        unsigned char c = s[i];
+        if (c == first && std::memcmp(s + i + 1, p + 1, m - 1) == 0) { return i; }
+        if (i < rshift[c]) { break; }
+        i -= rshift[c];
+    }
+    return npos;
+}
+
+void adt::string_search::build_failure(const char *p, size_t m, size_t *fail) {
+    fail[0] = 0;
+    for (size_t i = 1, k = 0; i != m; ++i) {
+        while (k > 0 && p[i] != p[k]) { k = fail[k - 1]; }
+        if (p[i] == p[k]) { ++k; }
+        fail[i] = k;
+    }
+}
+
+size_t adt::string_search::count(const char *s, size_t n, const char *p, size_t m,
+                                 bool overlapping) {
+    if (m == 0) { return n + 1; }
+    if (m > n) { return 0; }
+    if (m == 1) { return byte_scan::count(s, n, p[0]); }
+    /* short needles keep the failure function on the stack */
+    size_t stackFail[256];
+    std::vector<size_t> heapFail;
+    size_t *fail = stackFail;
+    if (m > 256) {
+        heapFail.resize(m);
+        fail = heapFail.data();
+    }
+    build_failure(p, m, fail);
+    return count_kmp(s, n, p, m, fail, overlapping, nullptr);
+}
+
+size_t adt::string_search::count_kmp(const char *s, size_t n, const char *p, size_t m,
+                                     const size_t *fail, bool overlapping,
+                                     std::vector<size_t> *found) {
+    if (m > n) { return 0; }
+    size_t count = 0;
+    for (size_t i = 0, k = 0; n - i >= m - k; ++i) { /* k: bytes matched */
+        if (k == 0) { /* nothing matched: jump to the next first byte */
+            size_t pos = byte_scan::find(s + i, n - i - m + 1, p[0]);
+            if (pos == byte_scan::npos) { break; }
+            i += pos;
+        }
+        while (k > 0 && s[i] != p[k]) { k = fail[k - 1]; }
+        if (s[i] == p[k]) { ++k; }
+        if (k == m) {
+            ++count;
+            if (found) { found->push_back(i + 1 - m); }
+            k = overlapping ? fail[m - 1] : 0;
+        }
+    }
+    return count;
+}
+
+size_t adt::string_search::find(const char *s, size_t n, const char *p, size_t m) {
+    if (m == 0) { return 0; }
+    if (m > n) { return npos; }
+    if (m == 1) { return byte_scan::find(s, n, p[0]); }
+    if (m <= short_needle_max) {
+        size_t a, b;
+        pick_rare_pair(p, m, a, b);
+        return byte_scan::find_substr(s, n, p, m, a, b);
+    }
+    uint32_t shift[256];
+    build_shifts(p, m, shift);
+    return find_horspool(s, n, p, m, shift);
+}
+
+size_t adt::string_search::rfind(const char *s, size_t n, const char *p, size_t m) {
+    if (m == 0) { return 0; }
+    if (m > n) { return npos; }
+    if (m == 1) { return byte_scan::rfind(s, n, p[0]); }
+    if (m <= short_needle_max) {
+        size_t a, b;
+        pick_rare_pair(p, m, a, b);
+        return byte_scan::rfind_substr(s, n, p, m, a, b);
+    }
+    uint32_t rshift[256];
+    build_rshifts(p, m, rshift);
+    return rfind_horspool(s, n, p, m, rshift);
+}
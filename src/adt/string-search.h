@@ -0,0 +1,72 @@
+/**
+ * File: string-search.h
+ * ---------------------------
+ * Internal header, not installed. Exports the substring search engine behind
+ * string_ref::find_str(): a memmem-like search over (pointer, length) pairs
+ * that respects the lengths (no '\0' needed) and never allocates.
+ */
+
+#ifndef STRING_SEARCH_H
+#define STRING_SEARCH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace adt {
+namespace string_search {
+    /* largest size_t value, the same as string_ref::npos */
+    static const size_t npos = (size_t)-1;
+
+    /* Needles up to this length are searched with the SIMD first/last byte
+     * filter, longer ones with Boyer-Moore-Horspool, whose shifts grow with
+     * the needle length. */
+    static const size_t short_needle_max = 32;
+
+    /* Picks the two positions a < b of the needle [p, p + m) whose bytes are
+     * the rarest in typical text, to feed byte_scan::find_substr(). The two
+     * bytes differ whenever the needle has two different bytes. m >= 2. */
+    void pick_rare_pair(const char *p, size_t m, size_t &a, size_t &b);
+
+    /* Fills the 256-entry Horspool shift table of the needle [p, p + m) for
+     * the forward search (build_shifts) or the reverse search (build_rshifts).
+     * m >= 1 */
+    void build_shifts(const char *p, size_t m, uint32_t *shift);
+    void build_rshifts(const char *p, size_t m, uint32_t *rshift);
+
+    /* Horspool searches with tables made by build_shifts()/build_rshifts().
+     * m >= 1 */
+    size_t find_horspool(const char *s, size_t n, const char *p, size_t m,
+                         const uint32_t *shift);
+    size_t rfind_horspool(const char *s, size_t n, const char *p, size_t m,
+                          const uint32_t *rshift);
+
+    /* Returns the index of the first occurrence of the needle [p, p + m) in
+     * [s, s + n), else npos. An empty needle is found at index 0. */
+    size_t find(const char *s, size_t n, const char *p, size_t m);
+
+    /* Fills the KMP failure function of the needle [p, p + m): fail[i] is the
+     * length of the longest proper prefix of p[0..i] that is also its suffix.
+     * m >= 1 */
+    void build_failure(const char *p, size_t m, size_t *fail);
+
+    /* Counts the occurrences of the needle [p, p + m) in [s, s + n) in O(n+m)
+     * with KMP, skipping the stretches that cannot start a match with the
+     * vectorized byte search. Overlapping occurrences are all counted if
+     * overlapping is true; otherwise the scan resumes after each match.
+     * An empty needle occurs at every index in [0, n]. */
+    size_t count(const char *s, size_t n, const char *p, size_t m, bool overlapping);
+
+    /* The scan behind count(), with the failure function fail made by
+     * build_failure(). If found is not NULL, the index of each occurrence is
+     * also appended to it. m >= 2 */
+    size_t count_kmp(const char *s, size_t n, const char *p, size_t m,
+                     const size_t *fail, bool overlapping, std::vector<size_t> *found);
+
+    /* Returns the index of the last occurrence of the needle [p, p + m) in
+     * [s, s + n), else npos. An empty needle is found at index 0. */
+    size_t rfind(const char *s, size_t n, const char *p, size_t m);
+}
+}
+
+#endif
@@ -0,0 +1,80 @@
+/**
+ * File: string-searcher.cc
+ * ---------------------------
+ * Implements class string_ref_searcher.
+ */
+
+#include "adt/string-searcher.h"
+#include "byte-scan.h"
+#include "string-search.h"
+
+const size_t adt::string_ref_searcher::npos;
+
+adt::string_ref_searcher::string_ref_searcher(string_ref pattern)
+: needle(pattern), rareA(0), rareB(0), shift(), rshift() {
+    const char *p = needle.ptr();
+    size_t m = needle.size();
+    if (m == 0) { return; }
+    fail.resize(m);
+    string_search::build_failure(p, m, fail.data());
+    if (m == 1) { return; }
+    if (m <= string_search::short_needle_max) {
+        string_search::pick_rare_pair(p, m, rareA, rareB);
+    } else {
+        string_search::build_shifts(p, m, shift);
+        string_search::build_rshifts(p, m, rshift);
+    }
+}
+
+size_t adt::string_ref_searcher::find(string_ref haystack, size_t start) const {
+    if (start > haystack.size()) { return npos; }
+    const char *s = haystack.ptr() + start, *p = needle.ptr();
+    size_t n = haystack.size() - start, m = needle.size(), pos;
+    if (m == 0) { return start; }
+    if (m > n) { return npos; }
+    if (m == 1) {
+        pos = byte_scan::find(s, n, p[0]);
+    } else if (m <= string_search::short_needle_max) {
+        pos = byte_scan::find_substr(s, n, p, m, rareA, rareB);
+    } else {
+        pos = string_search::find_horspool(s, n, p, m, shift);
+    }
+    return pos == byte_scan::npos ? npos : start + pos;
+}
+
+size_t adt::string_ref_searcher::rfind(string_ref haystack, size_t rstart) const {
+    const char *s = haystack.ptr(), *p = needle.ptr();
+    size_t m = needle.size();
+    if (m == 0) { return 0; }
+    /* an occurrence starting at or before rstart ends before rstart + m */
+    size_t n = (rstart < haystack.size() - std::min(m, haystack.size()))
+               ? rstart + m : haystack.size();
+    if (m > n) { return npos; }
+    if (m == 1) { return byte_scan::rfind(s, n, p[0]); }
+    if (m <= string_search::short_needle_max) {
+        return byte_scan::rfind_substr(s, n, p, m, rareA, rareB);
+    }
+    return string_search::rfind_horspool(s, n, p, m, rshift);
+}
+
+size_t adt::string_ref_searcher::count(string_ref haystack, bool overlapping) const {
+    size_t m = needle.size();
+    if (m == 0) { return haystack.size() + 1; }
+    if (m == 1) { return byte_scan::count(haystack.ptr(), haystack.size(), needle[0]); }
+    return string_search::count_kmp(haystack.ptr(), haystack.size(), needle.ptr(), m,
+                                    fail.data(), overlapping, nullptr);
+}
+
+std::vector<size_t> adt::string_ref_searcher::find_all(string_ref haystack,
+                                                       bool overlapping) const {
+    std::vector<size_t> found;
+    if (needle.size() <= 1) { /* every match is one step past the previous */
+        for (size_t pos = find(haystack); pos != npos; pos = find(haystack, pos + 1)) {
+            found.push_back(pos);
+        }
+    } else {
+        string_search::count_kmp(haystack.ptr(), haystack.size(), needle.ptr(),
+                                 needle.size(), fail.data(), overlapping, &found);
+    }
+    return found;
+}
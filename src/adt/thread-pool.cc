@@ -0,0 +1,119 @@
+/**
+ * File: thread-pool.cc
+ * ---------------------------
+ * Implements class thread_pool.
+ */
+
+#include "adt/thread-pool.h"
+#include <algorithm>
+
+namespace {
+
+/* The pool whose iterations this thread runs, if any: a parallel_for() on it
+ * from inside one of its tasks would wait for itself */
+thread_local const adt::thread_pool *currentPool = nullptr;
+
+}
+
+adt::thread_pool::thread_pool(size_t num_threads)
+: job(nullptr), generation(0), busy(0), stopping(false) {
+    if (num_threads == 0) { num_threads = std::max(1u, std::thread::hardware_concurrency()); }
+    ranges.reset(new range[num_threads]);
+    for (size_t i = 0; i + 1 < num_threads; ++i) {
+        workers.emplace_back(&thread_pool::workerLoop, this, i);
+    }
+}
+
+adt::thread_pool::~thread_pool() {
+    {
+        std::lock_guard<std::mutex> guard(jobLock);
+        stopping = true;
+    }
+    jobReady.notify_all();
+    for (std::thread &worker : workers) { worker.join(); }
+}
+
+adt::thread_pool &adt::thread_pool::shared() {
+    static thread_pool pool;
+    return pool;
+}
+
+void adt::thread_pool::parallel_for(size_t count, const std::function<void(size_t)> &task) {
+    if (workers.empty() || count <= 1 || currentPool == this) {
+        for (size_t i = 0; i != count; ++i) { task(i); }
+        return;
+    }
+    std::lock_guard<std::mutex> call(callLock);
+    const size_t threads = size();
+    for (size_t t = 0; t != threads; ++t) {
+        std::lock_guard<std::mutex> guard(ranges[t].lock);
+        ranges[t].next = count * t / threads;
+        ranges[t].end = count * (t + 1) / threads;
+    }
+    {
+        std::lock_guard<std::mutex> guard(jobLock);
+        job = &task;
+        busy = workers.size();
+        ++generation;
+    }
+    jobReady.notify_all();
+    const thread_pool *outer = currentPool;
+    currentPool = this;
+    participate(threads - 1);
+    currentPool = outer;
+    std::unique_lock<std::mutex> guard(jobLock);
+    jobDone.wait(guard, [this]() { return busy == 0; });
+    job = nullptr;
+}
+
+void adt::thread_pool::workerLoop(size_t self) {
+    currentPool = this;
+    uint64_t seen = 0;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> guard(jobLock);
+            jobReady.wait(guard, [&]() { return stopping || generation != seen; });
+            if (stopping) { return; }
+            seen = generation;
+        }
+        participate(self);
+        std::lock_guard<std::mutex> guard(jobLock);
+        if (--busy == 0) { jobDone.notify_one(); }
+    }
+}
+
+void adt::thread_pool::participate(size_t self) {
+    size_t index;
+    while (take(self, index)) { (*job)(index); }
+}
+
+bool adt::thread_pool::take(size_t self, size_t &index) {
+    {
+        range &own = ranges[self];
+        std::lock_guard<std::mutex> guard(own.lock);
+        if (own.next != own.end) {
+            index = own.next++;
+            return true;
+        }
+    }
+    /* steals the second half of the first other range with work left */
+    const size_t threads = size();
+    for (size_t k = 1; k != threads; ++k) {
+        range &victim = ranges[(self + k) % threads];
+        size_t first, last;
+        {
+            std::lock_guard<std::mutex> guard(victim.lock);
+            if (victim.next == victim.end) { continue; }
+            first = victim.next + (victim.end - victim.next) / 2;
+            last = victim.end;
+            victim.end = first;
+        }
+        index = first;
+        range &own = ranges[self];
+        std::lock_guard<std::mutex> guard(own.lock);
+        own.next = first + 1;
+        own.end = last;
+        return true;
+    }
+    return false;
+}
@@ -0,0 +1,68 @@
+/**
+ * File: arena-test.cc
+ * ---------------------------
+ * Test driver for class arena.
+ */
+
+#include "adt/arena.h"
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <string>
+using namespace adt;
+
+TEST(ArenaTest, Allocate) {
+    arena a(64);
+    EXPECT_EQ(0, a.bytes_reserved());
+    char *p = a.allocate_chars(3);
+    char *q = a.allocate_chars(5);
+    EXPECT_EQ(p + 3, q);  // bumped, not malloc'ed
+    void *r = a.allocate(16, 16);
+    EXPECT_EQ(0, (uintptr_t)r % 16);
+    EXPECT_EQ(24, a.bytes_used());
+    EXPECT_EQ(64, a.bytes_reserved());
+    // does not fit in what is left: a new, larger chunk
+    a.allocate_chars(60);
+    EXPECT_EQ(64 + 128, a.bytes_reserved());
+    // larger than a chunk: a chunk of its own, the current one keeps bumping
+    char *big = a.allocate_chars(1000);
+    std::memset(big, 'x', 1000);
+    char *next = a.allocate_chars(1);
+    EXPECT_TRUE(next < big || next >= big + 1000);
+    EXPECT_EQ(24 + 60 + 1000 + 1, a.bytes_used());
+}
+
+TEST(ArenaTest, CopyAndResize) {
+    arena a;
+    string_ref s = a.copy("hello");
+    EXPECT_STREQ("hello", s.ptr());  // null-terminated
+    EXPECT_EQ(5, s.size());
+    EXPECT_TRUE(a.copy(string_ref()).empty());
+    char *p = a.allocate_chars(4);
+    EXPECT_TRUE(a.try_resize(p, 4, 10));
+    EXPECT_EQ(p + 10, a.allocate_chars(1));
+    EXPECT_FALSE(a.try_resize(p, 10, 12));  // no longer the latest
+    char *q = a.allocate_chars(8);
+    EXPECT_FALSE(a.try_resize(q, 8, 1 << 20));  // no room
+    size_t used = a.bytes_used();
+    EXPECT_TRUE(a.try_resize(q, 8, 2));
+    EXPECT_EQ(used - 6, a.bytes_used());
+    EXPECT_EQ(q + 2, a.allocate_chars(1));  // given back
+}
+
+TEST(ArenaTest, Reset) {
+    arena a(64);
+    for (int i = 0; i < 100; ++i) { a.allocate_chars(50); }
+    size_t before = a.bytes_reserved();
+    a.reset();
+    EXPECT_EQ(0, a.bytes_used());
+    EXPECT_LT(a.bytes_reserved(), before);
+    EXPECT_GT(a.bytes_reserved(), 0);
+    size_t kept = a.bytes_reserved();
+    a.allocate_chars(50);
+    EXPECT_EQ(kept, a.bytes_reserved());  // reuses the kept chunk
+}
+
+int main(int argc, char **argv) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,92 @@
+/**
+ * File: concurrent-string-interner-test.cc
+ * ---------------------------
+ * Test driver for class concurrent_string_interner.
+ */
+
+#include "adt/concurrent-string-interner.h"
+#include <gtest/gtest.h>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+using namespace adt;
+
+TEST(ConcurrentStringInternerTest, Intern) {
+    concurrent_string_interner pool(4);
+    std::string key("Content-Type");
+    string_ref a = pool.intern(key);
+    EXPECT_NE(key.c_str(), a.ptr());
+    EXPECT_STREQ("Content-Type", a.ptr());
+    EXPECT_EQ(a.ptr(), pool.intern("Content-Type").ptr());
+    EXPECT_EQ(0, pool.intern_id("Content-Type"));
+    EXPECT_EQ(1, pool.intern_id(""));
+    EXPECT_EQ(1, pool.find_id(string_ref()));
+    EXPECT_EQ(concurrent_string_interner::invalid_id, pool.find_id("Accept"));
+    EXPECT_EQ(a, pool[0]);
+    EXPECT_EQ(2, pool.size());
+    concurrent_string_interner::statistics st = pool.stats();
+    EXPECT_EQ(2, st.strings);
+    EXPECT_EQ(12, st.unique_bytes);
+    EXPECT_GT(st.arena_bytes, 0);
+    EXPECT_GT(st.table_bytes, 0);
+}
+
+TEST(ConcurrentStringInternerTest, TooLong) {
+    // rejected before any character is read, so the bytes need not exist
+    concurrent_string_interner pool;
+    const char *text = "abc";
+    if (sizeof(size_t) > sizeof(uint32_t)) {
+        EXPECT_THROW(pool.intern(string_ref(text, UINT32_MAX)), std::length_error);
+        EXPECT_THROW(pool.intern_id(string_ref(text, (size_t)UINT32_MAX + 3)),
+                     std::length_error);
+    }
+    EXPECT_EQ(0, pool.size());
+    EXPECT_EQ(0, pool.intern_id(text));
+}
+
+TEST(ConcurrentStringInternerTest, ManyStrings) {
+    concurrent_string_interner pool(1);  // one shard: its table grows a lot
+    for (int i = 0; i < 5000; ++i) {
+        EXPECT_EQ((uint32_t)i, pool.intern_id(std::to_string(i)));
+    }
+    for (int i = 0; i < 5000; i += 3) {
+        EXPECT_EQ((uint32_t)i, pool.find_id(std::to_string(i)));
+        EXPECT_EQ(std::to_string(i), pool[i].to_string());
+    }
+}
+
+TEST(ConcurrentStringInternerTest, Threads) {
+    // the threads intern overlapping sets, in different orders
+    const int numThreads = 4, numKeys = 20000;
+    concurrent_string_interner pool(8);
+    std::vector<std::vector<string_ref> > seen(numThreads, std::vector<string_ref>(numKeys));
+    std::vector<std::thread> threads;
+    for (int t = 0; t < numThreads; ++t) {
+        threads.emplace_back([&pool, &seen, t, numKeys]() {
+            for (int i = 0; i < numKeys; ++i) {
+                int key = (t % 2 == 0) ? i : numKeys - 1 - i;
+                seen[t][key] = pool.intern("key-" + std::to_string(key));
+            }
+        });
+    }
+    for (std::thread &thread : threads) { thread.join(); }
+    EXPECT_EQ((size_t)numKeys, pool.size());
+    std::vector<bool> idSeen(numKeys, false);
+    for (int i = 0; i < numKeys; ++i) {
+        std::string key = "key-" + std::to_string(i);
+        for (int t = 0; t < numThreads; ++t) {
+            EXPECT_EQ(seen[0][i].ptr(), seen[t][i].ptr());
+        }
+        uint32_t id = pool.find_id(key);
+        ASSERT_LT(id, (uint32_t)numKeys);
+        EXPECT_FALSE(idSeen[id]);  // dense and unique
+        idSeen[id] = true;
+        EXPECT_EQ(seen[0][i].ptr(), pool[id].ptr());
+    }
+}
+
+int main(int argc, char **argv) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,123 @@
+/**
+ * File: keyword-map-test.cc
+ * ---------------------------
+ * Test driver for class template keyword_map.
+ */
+
+#include "adt/keyword-map.h"
+#include <gtest/gtest.h>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <vector>
+using namespace adt;
+
+/* maps are built at compile time where the compiler can (see compiler.h) */
+#if ADT_HAS_CONSTANT_EVALUATED
+#define KEYWORD_MAP_CONSTEXPR constexpr
+#else
+#define KEYWORD_MAP_CONSTEXPR const
+#endif
+
+namespace {
+    enum method_t { GET, HEAD, POST, PUT, DELETE, CONNECT, OPTIONS, TRACE, PATCH };
+
+    KEYWORD_MAP_CONSTEXPR auto methods = make_keyword_map<method_t>({
+        { "GET", GET }, { "HEAD", HEAD }, { "POST", POST }, { "PUT", PUT },
+        { "DELETE", DELETE }, { "CONNECT", CONNECT }, { "OPTIONS", OPTIONS },
+        { "TRACE", TRACE }, { "PATCH", PATCH } });
+
+    KEYWORD_MAP_CONSTEXPR auto headers = make_keyword_map_insensitive<int>({
+        { "Host", 0 }, { "Content-Type", 1 }, { "Content-Length", 2 },
+        { "Accept", 3 }, { "Accept-Encoding", 4 }, { "Connection", 5 },
+        { "User-Agent", 6 }, { "Cookie", 7 }, { "Authorization", 8 },
+        { "Transfer-Encoding", 9 }, { "Cache-Control", 10 } });
+
+    int add(int a, int b) { return a + b; }
+    int sub(int a, int b) { return a - b; }
+    typedef int (*op_t)(int, int);
+}
+
+TEST(KeywordMapTest, CompileTime) {
+#if ADT_HAS_CONSTANT_EVALUATED
+    static_assert(methods.size() == 9, "");
+    static_assert(*methods.find("GET") == GET && *methods.find("PATCH") == PATCH, "");
+    static_assert(methods.find("get") == nullptr && methods.find("GETS") == nullptr, "");
+    static_assert(methods.find("") == nullptr && !methods.contains("PUTT"), "");
+    static_assert(methods.lookup("OPTIONS", GET) == OPTIONS, "");
+    static_assert(methods.lookup("BREW", TRACE) == TRACE, "");
+    // one key, and keys of a single character
+    constexpr auto one = make_keyword_map<int>({ { "only", 7 } });
+    static_assert(one.lookup("only", 0) == 7 && !one.contains("onl"), "");
+    constexpr auto chars = make_keyword_map<char>({
+        { "a", 'a' }, { "b", 'b' }, { "c", 'c' }, { "", 'e' } });
+    static_assert(chars.lookup("b", 0) == 'b' && chars.lookup("", 0) == 'e', "");
+    static_assert(!chars.contains("ab"), "");
+#endif
+}
+
+TEST(KeywordMapTest, RunTime) {
+    const char *names[] = { "GET", "HEAD", "POST", "PUT", "DELETE", "CONNECT",
+                            "OPTIONS", "TRACE", "PATCH" };
+    for (int i = 0; i < 9; ++i) {
+        std::string name(names[i]);  // not the literals the map refers to
+        ASSERT_NE(nullptr, methods.find(name));
+        EXPECT_EQ(i, *methods.find(name));
+        EXPECT_FALSE(methods.contains(name + " "));
+        EXPECT_FALSE(methods.contains(string_ref(name).drop_back()));
+    }
+    EXPECT_EQ(1, headers.lookup("content-type", -1));
+    EXPECT_EQ(9, headers.lookup("TRANSFER-ENCODING", -1));
+    EXPECT_EQ(0, headers.lookup("host", -1));
+    EXPECT_EQ(-1, headers.lookup("hostname", -1));
+
+    keyword_entry<op_t> ops[] = { { "add", add }, { "sub", sub } };
+    keyword_map<op_t, 2> calc(ops);  // built at run time
+    EXPECT_EQ(5, (*calc.find("add"))(2, 3));
+    EXPECT_EQ(-1, calc.lookup("sub", nullptr)(2, 3));
+    EXPECT_EQ(nullptr, calc.lookup("mul", nullptr));
+}
+
+TEST(KeywordMapTest, Duplicates) {
+    keyword_entry<int> same[] = { { "get", 1 }, { "put", 2 }, { "get", 3 } };
+    EXPECT_THROW((keyword_map<int, 3>(same)), std::logic_error);
+    try {
+        keyword_map<int, 3> map(same);
+        ADD_FAILURE() << "duplicates accepted";
+    } catch (const std::logic_error &e) {
+        EXPECT_STREQ("keyword_map: duplicate keys", e.what());
+    }
+    // the same key but for its case: distinct unless case-insensitive
+    keyword_entry<int> cases[] = { { "Get", 1 }, { "GET", 2 } };
+    keyword_map<int, 2> sensitive(cases);
+    EXPECT_EQ(1, sensitive.lookup("Get", 0));
+    EXPECT_EQ(2, sensitive.lookup("GET", 0));
+    EXPECT_THROW((keyword_map<int, 2, false>(cases)), std::logic_error);
+    EXPECT_THROW(make_keyword_map_insensitive(cases), std::logic_error);
+}
+
+TEST(KeywordMapTest, ManyKeys) {
+    // every key lands in its own slot, whatever the key set
+    for (int round = 0; round < 20; ++round) {
+        std::vector<std::string> words;
+        for (int i = 0; i < 300; ++i) {
+            words.push_back("w" + std::to_string(round) + "-" + std::to_string(i * 7919));
+        }
+        keyword_entry<int> entries[300];
+        for (int i = 0; i < 300; ++i) { entries[i] = { words[i], i }; }
+        const keyword_map<int, 300> map(entries);
+        std::set<const int *> slots;
+        for (int i = 0; i < 300; ++i) {
+            ASSERT_NE(nullptr, map.find(words[i]));
+            EXPECT_EQ(i, *map.find(words[i]));
+            slots.insert(map.find(words[i]));
+        }
+        EXPECT_EQ(300, slots.size());
+        EXPECT_FALSE(map.contains("w" + std::to_string(round) + "-1"));
+    }
+}
+
+int main(int argc, char **argv) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,80 @@
+/**
+ * File: line-index-test.cc
+ * ---------------------------
+ * Test driver for class line_index.
+ */
+
+#include "adt/line-index.h"
+#include "byte-scan.h"
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+using namespace adt;
+
+namespace {
+    /* The lines of string_ref::lines(), the reference */
+    std::vector<string_ref> linesOf(string_ref text) {
+        std::vector<string_ref> lines;
+        for (string_ref line : text.lines()) { lines.push_back(line); }
+        return lines;
+    }
+}
+
+TEST(LineIndexTest, Small) {
+    line_index index("a\nbc\r\n\n\r\nd");
+    EXPECT_EQ(5, index.size());
+    EXPECT_EQ(string_ref("a"), index.line(0));
+    EXPECT_EQ(string_ref("bc"), index.line(1));
+    EXPECT_EQ(string_ref(""), index.line(2));
+    EXPECT_EQ(string_ref(""), index.line(3));
+    EXPECT_EQ(string_ref("d"), index.line(4));
+    EXPECT_EQ(0, index.line_of(0));
+    EXPECT_EQ(0, index.line_of(1));  // the '\n' ending line 0
+    EXPECT_EQ(1, index.line_of(2));
+    EXPECT_EQ(4, index.line_of(9));
+    EXPECT_EQ(0, line_index("").size());
+    EXPECT_TRUE(line_index("").begin() == line_index("").end());
+    EXPECT_EQ(1, line_index("\n").size());
+    EXPECT_EQ(2, line_index("x\ny\n").size());
+    EXPECT_EQ(string_ref("a\r"), line_index("a\r").line(0));
+}
+
+TEST(LineIndexTest, Large) {
+    // lines of all lengths around the 64-byte blocks, with empty ones
+    std::string text;
+    for (int i = 0; i < 3000; ++i) {
+        text += std::string(i * 7 % 150, 'a' + i % 26);
+        text += i % 5 == 0 ? "\r\n" : "\n";
+    }
+    text += "last";
+    string_ref sr(text);
+    std::vector<string_ref> expected = linesOf(sr);
+    // the same index with the newline bitmaps of every instruction set
+    std::string best = byte_scan::isa_name();
+    for (const char *isa : { "scalar", "sse2", "avx2", "avx512" }) {
+        if (!byte_scan::set_isa(isa)) { continue; }
+        SCOPED_TRACE(isa);
+        line_index index(sr);
+        ASSERT_EQ(expected.size(), index.size());
+        size_t i = 0;
+        for (string_ref line : index) {
+            EXPECT_EQ(expected[i].ptr(), line.ptr());
+            EXPECT_EQ(expected[i].size(), line.size());
+            ++i;
+        }
+        EXPECT_EQ(expected.size(), i);
+        for (size_t j = 0; j < expected.size(); j += 13) {
+            EXPECT_EQ(expected[j].ptr(), index.line(j).ptr());
+            EXPECT_EQ(expected[j], index.line(j));
+            size_t offset = expected[j].ptr() - sr.ptr();
+            if (offset < sr.size()) { EXPECT_EQ(j, index.line_of(offset)); }
+        }
+        EXPECT_EQ(string_ref("last"), index.line(index.size() - 1));
+    }
+    byte_scan::set_isa(best.c_str());
+}
+
+int main(int argc, char **argv) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,103 @@
+/**
+ * File: mapped-file-test.cc
+ * ---------------------------
+ * Test driver for class mapped_file.
+ */
+
+#include "adt/mapped-file.h"
+#include <gtest/gtest.h>
+#include <cerrno>
+#include <cstdio>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <unistd.h>
+using namespace adt;
+
+namespace {
+    /* Writes contents to a new temporary file, returns its path */
+    std::string writeTempFile(const std::string &contents) {
+        char path[] = "/tmp/mapped-file-test-XXXXXX";
+        int fd = mkstemp(path);
+        EXPECT_GE(fd, 0);
+        EXPECT_EQ((ssize_t)contents.size(), write(fd, contents.data(), contents.size()));
+        close(fd);
+        return path;
+    }
+
+    /* The kernel's VmFlags of the mapping holding p, "" if /proc is missing */
+    std::string vmFlags(const void *p) {
+        std::ifstream smaps("/proc/self/smaps");
+        std::string line;
+        bool inside = false;
+        while (std::getline(smaps, line)) {
+            unsigned long first, last;
+            if (std::sscanf(line.c_str(), "%lx-%lx ", &first, &last) == 2) {
+                inside = first <= (uintptr_t)p && (uintptr_t)p < last;
+            } else if (inside && line.compare(0, 8, "VmFlags:") == 0) {
+                return line.substr(8) + " ";
+            }
+        }
+        return "";
+    }
+}
+
+TEST(MappedFileTest, Map) {
+    std::string contents;
+    for (int i = 0; i < 10000; ++i) { contents += "line " + std::to_string(i) + "\n"; }
+    std::string path = writeTempFile(contents);
+    mapped_file file(path, mapped_file::sequential | mapped_file::willneed
+                           | mapped_file::huge_pages);
+    ASSERT_TRUE(file.is_open());
+    EXPECT_EQ(0, file.error());
+    EXPECT_EQ(contents.size(), file.size());
+    EXPECT_EQ(string_ref(contents), file.view());
+    EXPECT_EQ(10000, file.view().count_char('\n'));
+    EXPECT_EQ(contents.find("line 9999"), file.view().find_str("line 9999"));
+    file.advise(mapped_file::random);
+    std::string flags = vmFlags(file.data());
+    if (!flags.empty()) {
+        EXPECT_NE(std::string::npos, flags.find(" rr "));
+        file.advise(mapped_file::normal);
+        flags = vmFlags(file.data());
+        EXPECT_EQ(std::string::npos, flags.find(" rr "));
+        EXPECT_EQ(std::string::npos, flags.find(" sr "));
+    }
+    file.close();
+    EXPECT_FALSE(file.is_open());
+    EXPECT_TRUE(file.view().empty());
+    std::remove(path.c_str());
+}
+
+TEST(MappedFileTest, EmptyAndMissing) {
+    std::string path = writeTempFile("");
+    mapped_file empty(path);
+    EXPECT_TRUE(empty.is_open());
+    EXPECT_TRUE(empty.view().empty());
+    std::remove(path.c_str());
+
+    mapped_file missing("/nonexistent/mapped-file-test");
+    EXPECT_FALSE(missing.is_open());
+    EXPECT_EQ(ENOENT, missing.error());
+    EXPECT_TRUE(missing.view().empty());
+}
+
+TEST(MappedFileTest, Move) {
+    std::string path = writeTempFile("abc");
+    mapped_file a(path);
+    mapped_file b(std::move(a));
+    EXPECT_FALSE(a.is_open());
+    EXPECT_EQ(string_ref("abc"), b.view());
+    mapped_file c;
+    c = std::move(b);
+    EXPECT_FALSE(b.is_open());
+    EXPECT_EQ(string_ref("abc"), c.view());
+    EXPECT_TRUE(c.open(path));  // reopening unmaps first
+    EXPECT_EQ(string_ref("abc"), c.view());
+    std::remove(path.c_str());
+}
+
+int main(int argc, char **argv) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,88 @@
+/**
+ * File: multi-pattern-matcher-test.cc
+ * ---------------------------
+ * Test driver for class multi_pattern_matcher.
+ */
+
+#include "adt/multi-pattern-matcher.h"
+#include <gtest/gtest.h>
+#include <stdexcept>
+using namespace adt;
+
+/* "id@offset" list, for readable expectations */
+static std::string describe(const std::vector<multi_pattern_matcher::match> &found) {
+    std::string res;
+    for (const auto &m : found) {
+        if (!res.empty()) { res += " "; }
+        res += std::to_string(m.id) + "@" + std::to_string(m.offset);
+    }
+    return res;
+}
+
+TEST(MultiPatternMatcherTest, FindAll) {
+    multi_pattern_matcher matcher({ "he", "she", "his", "hers" });
+    EXPECT_EQ(4, matcher.size());
+    EXPECT_EQ("1@1 0@2 3@2", describe(matcher.find_all("ushers")));
+    EXPECT_EQ("2@0", describe(matcher.find_all("his")));
+    EXPECT_EQ("", describe(matcher.find_all("xyz")));
+    EXPECT_EQ("", describe(matcher.find_all("")));
+    EXPECT_EQ("", describe(matcher.find_all("HERS")));
+}
+
+TEST(MultiPatternMatcherTest, OverlapsAndDuplicates) {
+    multi_pattern_matcher matcher({ "a", "aa", "", "aa" });
+    EXPECT_EQ("0@0 1@0 3@0 0@1 1@1 3@1 0@2", describe(matcher.find_all("aaa")));
+    // the haystack need not be '\0'-terminated
+    EXPECT_EQ("0@0", describe(matcher.find_all(string_ref("aaa", 1))));
+}
+
+TEST(MultiPatternMatcherTest, CaseInsensitive) {
+    multi_pattern_matcher matcher({ "GET", "Post", "x-id" }, false);
+    EXPECT_EQ("0@0", describe(matcher.find_all("get /")));
+    EXPECT_EQ("1@0", describe(matcher.find_all("POST /")));
+    EXPECT_EQ("2@1", describe(matcher.find_all(" X-ID: 1")));
+    EXPECT_EQ("", describe(matcher.find_all("X_ID")));
+}
+
+TEST(MultiPatternMatcherTest, ScanAndContainsAny) {
+    multi_pattern_matcher matcher({ "error", "warn", "fatal" });
+    EXPECT_TRUE(matcher.contains_any("2024 [warn] disk"));
+    EXPECT_FALSE(matcher.contains_any("2024 [info] disk"));
+    size_t calls = 0;
+    matcher.scan("error error error", [&calls](const multi_pattern_matcher::match &) {
+        return ++calls < 2;
+    });
+    EXPECT_EQ(2, calls);
+    // agrees with string_ref::count_str() on every keyword
+    std::vector<string_ref> words = { "ab", "ba", "aab", "b", "abab" };
+    multi_pattern_matcher all(words);
+    string_ref hay("abaababbabaabab");
+    std::vector<size_t> counts(words.size(), 0);
+    all.scan(hay, [&](const multi_pattern_matcher::match &m) {
+        EXPECT_TRUE(hay.substr(m.offset, words[m.id].size()).equals(words[m.id]));
+        ++counts[m.id];
+        return true;
+    });
+    for (size_t id = 0; id != words.size(); ++id) {
+        EXPECT_EQ(hay.count_str(words[id]), counts[id]);
+    }
+}
+
+TEST(MultiPatternMatcherTest, TooManyStates) {
+    // every byte value: 257 classes, so 2^23 states reach 2^31 table entries
+    std::string huge(1 << 23, '\0');
+    for (size_t i = 0; i != huge.size(); ++i) { huge[i] = (char)i; }
+    EXPECT_THROW(multi_pattern_matcher({ huge }), std::length_error);
+    // as many pattern bytes, but shared prefixes: few states
+    string_ref prefix = string_ref(huge).take_front(1 << 16);
+    std::vector<string_ref> copies(128, prefix);
+    copies.push_back(prefix.take_front(300));
+    multi_pattern_matcher shared(copies);
+    EXPECT_EQ(prefix.size() + 1, shared.state_count());
+    EXPECT_EQ(128 + prefix.count_str(copies.back()), shared.find_all(prefix).size());
+}
+
+int main(int argc, char **argv) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,98 @@
+/**
+ * File: parallel-search-test.cc
+ * ---------------------------
+ * Test driver for the parallel searches, checked against the serial ones.
+ */
+
+#include "adt/parallel-search.h"
+#include <gtest/gtest.h>
+#include <random>
+#include <string>
+using namespace adt;
+
+TEST(ParallelSearchTest, Small) {
+    thread_pool pool(4);
+    string_ref text("abaababaab");
+    // chunks of 3: "aba|aba|bab|aab", matches straddle the boundaries
+    EXPECT_EQ(6, parallel_count_char(text, 'a', pool, 3));
+    EXPECT_EQ(3, parallel_count_str(text, "aba", true, pool, 3));
+    EXPECT_EQ(2, parallel_count_str(text, "aba", false, pool, 3));
+    EXPECT_EQ(4, parallel_count_str(text, "ab", false, pool, 3));
+    EXPECT_EQ(0, parallel_find_str(text, "aba", pool, 3));
+    EXPECT_EQ(2, parallel_find_str(text, "aab", pool, 3));
+    EXPECT_EQ(4, parallel_find_str(text, "bab", pool, 3));
+    EXPECT_EQ(string_ref::npos, parallel_find_str(text, "bb", pool, 3));
+    EXPECT_EQ(11, parallel_count_str(text, "", true, pool, 3));
+    EXPECT_EQ(0, parallel_find_str(text, "", pool, 3));
+    // patterns longer than a chunk
+    EXPECT_EQ(1, parallel_count_str(text, "abaababaab", true, pool, 3));
+    EXPECT_EQ(2, parallel_find_str(text, "aababaab", pool, 3));
+    EXPECT_EQ(5, parallel_count_str("aaaaaaaaaaa", "aa", false, pool, 2));
+    EXPECT_EQ(3, parallel_count_str("aaaaaaaaaaa", "aaa", false, pool, 4));
+}
+
+TEST(ParallelSearchTest, MatchesSerial) {
+    std::mt19937 rng(20);
+    thread_pool pool(4);
+    for (int round = 0; round < 200; ++round) {
+        // small alphabets make many matches, overlapping ones and long runs
+        int alphabet = 1 + rng() % 3;
+        std::string text(rng() % 3000, 'a');
+        for (char &c : text) { c = 'a' + rng() % alphabet; }
+        std::string pattern(rng() % 12, 'a');
+        for (char &c : pattern) { c = 'a' + rng() % alphabet; }
+        size_t chunk = 1 + rng() % 200;
+        string_ref sr(text);
+        ASSERT_EQ(sr.count_char('a'), parallel_count_char(sr, 'a', pool, chunk));
+        ASSERT_EQ(sr.count_str(pattern), parallel_count_str(sr, pattern, true, pool, chunk))
+            << text << " / " << pattern << " / " << chunk;
+        ASSERT_EQ(sr.count_str(pattern, false),
+                  parallel_count_str(sr, pattern, false, pool, chunk))
+            << text << " / " << pattern << " / " << chunk;
+        ASSERT_EQ(sr.find_str(pattern), parallel_find_str(sr, pattern, pool, chunk))
+            << text << " / " << pattern << " / " << chunk;
+    }
+}
+
+TEST(ParallelSearchTest, Periodic) {
+    // a match at every index: restarting the search after each one would
+    // take text.size() * pattern.size() steps
+    thread_pool pool(4);
+    std::string text(1 << 22, 'a'), pattern(1000, 'a');
+    EXPECT_EQ(text.size() - pattern.size() + 1,
+              parallel_count_str(text, pattern, true, pool, 1 << 16));
+    EXPECT_EQ(text.size() / pattern.size(),
+              parallel_count_str(text, pattern, false, pool, 1 << 16));
+}
+
+TEST(ParallelSearchTest, Nested) {
+    // searches run from the tasks of the pool they use
+    std::string text(100000, 'a');
+    auto check = [&text](thread_pool &pool) {
+        std::vector<size_t> counts(6);
+        pool.parallel_for(counts.size(), [&](size_t i) {
+            counts[i] = parallel_count_char(text, 'a', pool, 1000) +
+                        parallel_count_str(text, "aa", false, pool, 1000);
+        });
+        for (size_t found : counts) { EXPECT_EQ(150000, found); }
+    };
+    thread_pool pool(4);
+    check(pool);
+    check(thread_pool::shared());
+}
+
+TEST(ParallelSearchTest, DefaultChunks) {
+    std::string text(3 * parallel_chunk_size + 123, 'x');
+    text.replace(parallel_chunk_size - 2, 5, "needl");
+    text.replace(2 * parallel_chunk_size - 3, 6, "needle");
+    string_ref sr(text);
+    EXPECT_EQ(text.size() - 11, parallel_count_char(sr, 'x'));
+    EXPECT_EQ(2 * parallel_chunk_size - 3, parallel_find_str(sr, "needle"));
+    EXPECT_EQ(1, parallel_count_str(sr, "needle"));
+    EXPECT_EQ(2, parallel_count_str(sr, "needl", false));
+}
+
+int main(int argc, char **argv) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
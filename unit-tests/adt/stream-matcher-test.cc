@@ -0,0 +1,98 @@
+/**
+ * File: stream-matcher-test.cc
+ * ---------------------------
+ * Test driver for class stream_matcher.
+ */
+
+#include "adt/stream-matcher.h"
+#include <gtest/gtest.h>
+#include <random>
+#include <string>
+#include <vector>
+using namespace adt;
+
+namespace {
+    /* The occurrences in the whole text, the reference */
+    std::vector<size_t> findAll(string_ref text, string_ref pattern, bool overlapping) {
+        std::vector<size_t> offsets;
+        if (pattern.empty()) { return offsets; }
+        for (size_t pos = text.find_str(pattern); pos != string_ref::npos; ) {
+            offsets.push_back(pos);
+            size_t next = pos + (overlapping ? 1 : pattern.size());
+            pos = text.substr(next).find_str(pattern);
+            if (pos != string_ref::npos) { pos += next; }
+        }
+        return offsets;
+    }
+}
+
+TEST(StreamMatcherTest, Straddling) {
+    stream_matcher m("\r\n\r\n");
+    EXPECT_TRUE(m.feed("GET / HTTP/1.1\r").empty());
+    EXPECT_EQ(1, m.pending());
+    EXPECT_TRUE(m.feed("\nHost: x\r\n").empty());
+    EXPECT_EQ(2, m.pending());
+    EXPECT_TRUE(m.feed("\r").empty());
+    EXPECT_EQ((std::vector<size_t>{ 23, 31 }), m.feed("\nbody\r\n\r\n"));
+    EXPECT_EQ(35, m.position());
+    m.reset();
+    EXPECT_EQ(0, m.position());
+    EXPECT_EQ(std::vector<size_t>{ 1 }, m.feed("x\r\n\r\n"));
+
+    stream_matcher overlapping("aa"), greedy("aa", false);
+    std::vector<size_t> all, some;
+    for (char c : std::string("aaaaa")) {
+        std::vector<size_t> got = overlapping.feed(string_ref(&c, 1));
+        all.insert(all.end(), got.begin(), got.end());
+        got = greedy.feed(string_ref(&c, 1));
+        some.insert(some.end(), got.begin(), got.end());
+    }
+    EXPECT_EQ((std::vector<size_t>{ 0, 1, 2, 3 }), all);
+    EXPECT_EQ((std::vector<size_t>{ 0, 2 }), some);
+
+    stream_matcher empty("");
+    EXPECT_TRUE(empty.feed("abc").empty());
+    EXPECT_EQ(3, empty.position());
+}
+
+TEST(StreamMatcherTest, StopEarly) {
+    stream_matcher m("ab");
+    std::vector<size_t> offsets;
+    auto firstOnly = [&](size_t offset) { offsets.push_back(offset); return false; };
+    EXPECT_EQ(3, m.feed("xab-ab-a", firstOnly));
+    EXPECT_EQ(3, m.position());
+    EXPECT_EQ(3, m.feed("-ab-a", firstOnly));  // the rest, fed again
+    EXPECT_EQ(2, m.feed("-a", firstOnly));
+    EXPECT_EQ(1, m.pending());
+    EXPECT_EQ(1, m.feed("b", firstOnly));
+    EXPECT_EQ(9, m.position());
+    EXPECT_EQ((std::vector<size_t>{ 1, 4, 7 }), offsets);
+}
+
+TEST(StreamMatcherTest, MatchesWholeText) {
+    std::mt19937 rng(21);
+    for (int round = 0; round < 300; ++round) {
+        int alphabet = 1 + rng() % 3;
+        std::string text(rng() % 2000, 'a');
+        for (char &c : text) { c = 'a' + rng() % alphabet; }
+        std::string pattern(1 + rng() % 40, 'a');
+        for (char &c : pattern) { c = 'a' + rng() % alphabet; }
+        bool overlapping = rng() % 2;
+        stream_matcher m(pattern, overlapping);
+        std::vector<size_t> offsets;
+        for (size_t pos = 0; pos < text.size(); ) {
+            size_t len = std::min<size_t>(rng() % 64, text.size() - pos);
+            std::vector<size_t> got = m.feed(string_ref(text).substr(pos, len));
+            offsets.insert(offsets.end(), got.begin(), got.end());
+            pos += len;
+        }
+        ASSERT_EQ(text.size(), m.position());
+        ASSERT_EQ(findAll(text, pattern, overlapping), offsets)
+            << text << " / " << pattern << " / " << overlapping;
+    }
+}
+
+int main(int argc, char **argv) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
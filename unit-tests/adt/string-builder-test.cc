@@ -0,0 +1,83 @@
+/**
+ * File: string-builder-test.cc
+ * ---------------------------
+ * Test driver for class string_builder.
+ */
+
+#include "adt/string-builder.h"
+#include <gtest/gtest.h>
+#include <climits>
+#include <string>
+#include <vector>
+using namespace adt;
+
+TEST(StringBuilderTest, Append) {
+    arena a;
+    string_builder sb(a);
+    EXPECT_TRUE(sb.empty());
+    sb.append("key").append('=').append(string_ref("value; x", 5));
+    EXPECT_EQ(9, sb.size());
+    EXPECT_EQ(string_ref("key=value"), sb.view());
+    string_ref s = sb.finish();
+    EXPECT_STREQ("key=value", s.ptr());  // null-terminated
+    EXPECT_TRUE(sb.empty());
+    string_ref empty = sb.finish();
+    EXPECT_TRUE(empty.empty());
+    EXPECT_STREQ("", empty.ptr());
+    EXPECT_STREQ("key=value", s.ptr());  // untouched by later strings
+}
+
+TEST(StringBuilderTest, AppendInt) {
+    arena a;
+    string_builder sb(a);
+    EXPECT_STREQ("0", sb.append_int(0).finish().ptr());
+    EXPECT_STREQ("7", sb.append_int(7u).finish().ptr());
+    EXPECT_STREQ("-42", sb.append_int(-42).finish().ptr());
+    EXPECT_STREQ("100", sb.append_int(100L).finish().ptr());
+    EXPECT_STREQ("-9223372036854775808", sb.append_int(LLONG_MIN).finish().ptr());
+    EXPECT_STREQ("18446744073709551615", sb.append_int(ULLONG_MAX).finish().ptr());
+    for (long long v = -1000; v <= 100000; v += 37) {
+        EXPECT_EQ(std::to_string(v), sb.append_int(v).finish().to_string());
+    }
+}
+
+TEST(StringBuilderTest, GrowInPlace) {
+    arena a;
+    string_builder sb(a);
+    sb.reserve(10);
+    const char *before = sb.view().ptr();
+    std::string expected;
+    for (int i = 0; i < 1000; ++i) {
+        sb.append((char)('a' + i % 26));
+        expected += (char)('a' + i % 26);
+    }
+    EXPECT_EQ(expected, sb.view().to_string());
+    string_ref s = sb.finish();
+    EXPECT_EQ(before, s.ptr());  // grew at the bump pointer, never moved
+    // the unused room went back: the next string starts right after
+    string_ref t = sb.append("next").finish();
+    EXPECT_EQ(s.ptr() + s.size() + 1, t.ptr());
+}
+
+TEST(StringBuilderTest, Interleaved) {
+    // another allocation after the string: the string moves, keeps its contents
+    arena a;
+    string_builder sb(a);
+    sb.append("abc");
+    a.allocate_chars(8);
+    std::string big(5000, 'z');
+    sb.append(big);
+    EXPECT_EQ("abc" + big, sb.finish().to_string());
+    std::vector<string_ref> many;
+    for (int i = 0; i < 1000; ++i) {
+        many.push_back(sb.append("item-").append_int(i).finish());
+    }
+    for (int i = 0; i < 1000; ++i) {
+        EXPECT_EQ("item-" + std::to_string(i), many[i].to_string());
+    }
+}
+
+int main(int argc, char **argv) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,84 @@
+/**
+ * File: string-interner-test.cc
+ * ---------------------------
+ * Test driver for class string_interner.
+ */
+
+#include "adt/string-interner.h"
+#include <gtest/gtest.h>
+#include <stdexcept>
+#include <string>
+#include <vector>
+using namespace adt;
+
+TEST(StringInternerTest, Intern) {
+    string_interner pool;
+    std::string key("Content-Type");
+    string_ref a = pool.intern(key);
+    EXPECT_NE(key.c_str(), a.ptr());  // a copy
+    EXPECT_STREQ("Content-Type", a.ptr());
+    key[0] = 'X';  // the copy does not change
+    EXPECT_EQ(string_ref("Content-Type"), a);
+    EXPECT_EQ(a.ptr(), pool.intern("Content-Type").ptr());
+    EXPECT_NE(a.ptr(), pool.intern("content-type").ptr());
+    EXPECT_EQ(2, pool.size());
+    EXPECT_EQ(0, pool.intern_id("Content-Type"));
+    EXPECT_EQ(1, pool.intern_id("content-type"));
+    EXPECT_EQ(2, pool.intern_id(""));
+    EXPECT_EQ(2, pool.intern_id(string_ref()));
+    EXPECT_EQ(a, pool[0]);
+    EXPECT_EQ(string_ref(""), pool[2]);
+    EXPECT_EQ(1, pool.find_id("content-type"));
+    EXPECT_EQ(string_interner::invalid_id, pool.find_id("Accept"));
+    EXPECT_EQ(3, pool.size());
+}
+
+TEST(StringInternerTest, TooLong) {
+    // rejected before any character is read, so the bytes need not exist
+    string_interner pool;
+    const char *text = "abc";
+    if (sizeof(size_t) > sizeof(uint32_t)) {
+        EXPECT_THROW(pool.intern(string_ref(text, UINT32_MAX)), std::length_error);
+        EXPECT_THROW(pool.intern_id(string_ref(text, (size_t)UINT32_MAX + 3)),
+                     std::length_error);
+    }
+    EXPECT_EQ(0, pool.size());
+    EXPECT_EQ(0, pool.intern_id(text));
+}
+
+TEST(StringInternerTest, ManyStrings) {
+    string_interner pool(10);
+    std::vector<string_ref> refs;
+    for (int i = 0; i < 20000; ++i) {
+        refs.push_back(pool.intern(std::to_string(i)));
+    }
+    EXPECT_EQ(20000, pool.size());
+    // the table grew many times, the strings and ids stayed put
+    for (int i = 0; i < 20000; i += 7) {
+        std::string s = std::to_string(i);
+        EXPECT_EQ(refs[i].ptr(), pool.intern(s).ptr());
+        EXPECT_EQ((uint32_t)i, pool.find_id(s));
+        EXPECT_EQ(s, pool[i].to_string());
+    }
+    EXPECT_EQ(string_interner::invalid_id, pool.find_id("20000"));
+}
+
+TEST(StringInternerTest, Stats) {
+    string_interner pool;
+    pool.intern("abc");
+    pool.intern("abc");
+    pool.intern("abc");
+    pool.intern("de");
+    string_interner::statistics st = pool.stats();
+    EXPECT_EQ(2, st.strings);
+    EXPECT_EQ(4, st.interns);
+    EXPECT_EQ(5, st.unique_bytes);
+    EXPECT_EQ(6, st.duplicate_bytes);
+    EXPECT_GT(st.arena_bytes, 0);
+    EXPECT_GT(st.table_bytes, 0);
+}
+
+int main(int argc, char **argv) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
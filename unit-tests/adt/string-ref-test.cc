@@ -5,9 +5,35 @@
  */
 
 #include "adt/string-ref.h"
+#include "byte-scan.h"
 #include <gtest/gtest.h>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <cctype>
+#include <algorithm>
 using namespace adt;
 
+/* The instruction sets of the running CPU, the best last */
+static std::vector<const char *> cpuIsas() {
+    std::string best = byte_scan::isa_name();
+    std::vector<const char *> isas;
+    for (const char *isa : { "scalar", "sse2", "avx2", "avx512" }) {
+        if (byte_scan::set_isa(isa)) { isas.push_back(isa); }
+    }
+    byte_scan::set_isa(best.c_str());
+    return isas;
+}
+
+/* Runs a test once with the kernels of each instruction set */
+class StringRefKernelTest : public testing::TestWithParam<const char *> {
+protected:
+    void SetUp() override { byte_scan::set_isa(GetParam()); }
+    void TearDown() override { byte_scan::set_isa(cpuIsas().back()); }
+};
+
+INSTANTIATE_TEST_CASE_P(Isa, StringRefKernelTest, testing::ValuesIn(cpuIsas()));
+
 TEST(StringRefTest, AccessorGroup1) {
     string_ref srEmpty;
     EXPECT_TRUE(srEmpty.empty());
@@ -65,6 +91,195 @@ TEST(StringRefTest, AccessorGroup2) {
     EXPECT_EQ(2, sr2.count_str("ab"));
 }
 
+TEST_P(StringRefKernelTest, LongBufferScan) {
+    // long enough to go through the vectorized kernels and their tails
+    std::string s(1000, 'a');
+    s[3] = 'b'; s[64] = 'b'; s[517] = 'b'; s[999] = 'b';
+    for (size_t offset = 0; offset < 40; ++offset) {
+        string_ref sr(s.c_str() + offset, s.size() - offset);
+        EXPECT_EQ(offset <= 3 ? 3 - offset : 64 - offset, sr.find_char('b'));
+        EXPECT_EQ(517 - offset, sr.find_char('b', 65 - offset));
+        EXPECT_EQ(999 - offset, sr.find_char('b', 518 - offset));
+        EXPECT_EQ(string_ref::npos, sr.find_char('c'));
+        EXPECT_EQ(string_ref::npos, sr.find_char('b', 1000));
+        EXPECT_EQ(offset <= 3 ? 4 : 3, sr.count_char('b'));
+        EXPECT_EQ(996 - offset + (offset <= 3 ? 0 : 1), sr.count_char('a'));
+    }
+    // the byte counters must not wrap around on large inputs
+    std::string big(100000, '\xff');
+    EXPECT_EQ(100000, string_ref(big).count_char('\xff'));
+    EXPECT_EQ(0, string_ref(big).count_char('\0'));
+}
+
+TEST_P(StringRefKernelTest, FindStr) {
+    // the search is bounded by the length, not by a '\0'
+    string_ref sr("abcdefabcdef", 8);
+    EXPECT_EQ(0, sr.find_str(""));
+    EXPECT_EQ(2, sr.find_str("cd"));
+    EXPECT_EQ(string_ref::npos, sr.find_str("cde f"));
+    EXPECT_EQ(string_ref::npos, sr.find_str("fabcd"));
+    EXPECT_EQ(5, string_ref("abcdefabcdef", 10).find_str("fabcd"));
+    EXPECT_EQ(string_ref::npos, sr.find_str("efabcd"));
+    EXPECT_EQ(4, sr.find_str("efab"));
+    EXPECT_EQ(string_ref::npos, sr.find_str("abcdefabc"));
+    EXPECT_EQ(string_ref::npos, string_ref().find_str("a"));
+    std::string withNul("ab\0cd\0ef", 8);
+    EXPECT_EQ(5, string_ref(withNul).find_str(string_ref("\0ef", 3)));
+    // short needles (vector filter) and long needles (Horspool) at every
+    // position, compared against std::string::find
+    std::string hay;
+    for (int i = 0; i < 500; ++i) { hay += "abcab"[i % 5] + (i % 7 == 0 ? 1 : 0); }
+    for (size_t m = 1; m <= 70; m += 3) {
+        for (size_t at = 0; at + m <= hay.size(); at += 37) {
+            std::string needle = hay.substr(at, m);
+            EXPECT_EQ(hay.find(needle), string_ref(hay).find_str(needle));
+        }
+        std::string missing(m, 'z');
+        EXPECT_EQ(string_ref::npos, string_ref(hay).find_str(missing));
+    }
+}
+
+TEST_P(StringRefKernelTest, RFindStr) {
+    string_ref sr("abcdefabcdef", 10);
+    EXPECT_EQ(0, sr.rfind_str(""));
+    EXPECT_EQ(8, sr.rfind_str("cd"));
+    EXPECT_EQ(2, sr.rfind_str("cde"));
+    EXPECT_EQ(5, sr.rfind_str("fabcd"));
+    EXPECT_EQ(2, sr.rfind_str("cdef"));
+    EXPECT_EQ(string_ref::npos, sr.rfind_str("abcdefabcde"));
+    EXPECT_EQ(string_ref::npos, string_ref().rfind_str("a"));
+    EXPECT_EQ(string_ref::npos, sr.rfind_char('z'));
+    EXPECT_EQ(string_ref::npos, string_ref().rfind_char('a'));
+    EXPECT_EQ(6, sr.rfind_char('a'));
+    EXPECT_EQ(0, sr.rfind_char('a', 5));
+    auto path = string_ref("/usr/local/lib/libfoo.so").rsplit("/");
+    EXPECT_STREQ("/usr/local/lib", path.first.to_string().c_str());
+    EXPECT_STREQ("libfoo.so", path.second.to_string().c_str());
+    std::string hay;
+    for (int i = 0; i < 500; ++i) { hay += "abcab"[i % 5] + (i % 7 == 0 ? 1 : 0); }
+    for (size_t m = 1; m <= 70; m += 3) {
+        for (size_t at = 0; at + m <= hay.size(); at += 37) {
+            std::string needle = hay.substr(at, m);
+            EXPECT_EQ(hay.rfind(needle), string_ref(hay).rfind_str(needle));
+        }
+        std::string missing(m, 'z');
+        EXPECT_EQ(string_ref::npos, string_ref(hay).rfind_str(missing));
+    }
+}
+
+TEST_P(StringRefKernelTest, CountStr) {
+    string_ref sr("aaaabaaa");
+    EXPECT_EQ(5, sr.count_str("aa"));
+    EXPECT_EQ(5, sr.count_str("aa", true));
+    EXPECT_EQ(3, sr.count_str("aa", false));
+    EXPECT_EQ(2, string_ref("abababa").count_str("aba", false));
+    EXPECT_EQ(3, string_ref("abababa").count_str("aba"));
+    EXPECT_EQ(9, sr.count_str(""));
+    EXPECT_EQ(0, sr.count_str("aaaaa"));
+    EXPECT_EQ(0, sr.count_str("aaaabaaab"));
+    EXPECT_EQ(1, sr.count_str("aaaabaaa"));
+    EXPECT_EQ(0, string_ref().count_str("a"));
+    // long periodic patterns, where the naive count is quadratic
+    std::string hay(3000, 'a'), pattern(300, 'a');
+    EXPECT_EQ(2701, string_ref(hay).count_str(pattern));
+    EXPECT_EQ(10, string_ref(hay).count_str(pattern, false));
+    hay[1500] = 'b';
+    EXPECT_EQ(2401, string_ref(hay).count_str(pattern));
+    EXPECT_EQ(9, string_ref(hay).count_str(pattern, false));
+}
+
+static bool isVowel(char c) { return std::strchr("aeiou", c) != nullptr; }
+
+TEST_P(StringRefKernelTest, PredicateSearch) {
+    string_ref sr("  key = 42\t");
+    // lambdas, function pointers and std::function agree
+    std::function<bool(char)> isEq = [](char c) { return c == '='; };
+    EXPECT_EQ(6, sr.find_if(isEq));
+    EXPECT_EQ(6, sr.find_if([](char c) { return c == '='; }));
+    EXPECT_EQ(3, sr.find_if(isVowel));
+    EXPECT_EQ(3, sr.rfind_if(isVowel));
+    EXPECT_EQ(string_ref::npos, sr.find_if(isVowel, 4));
+    EXPECT_EQ(string_ref::npos, sr.rfind_if(isVowel, 2));
+    EXPECT_EQ(string_ref::npos, string_ref().rfind_if(isVowel));
+    EXPECT_EQ(string_ref::npos, string_ref().rfind_if(isEq));
+    EXPECT_EQ(string_ref::npos, string_ref().rfind_if_not(char_class::space));
+    // character classes
+    EXPECT_EQ(0, sr.find_if(char_class::space));
+    EXPECT_EQ(2, sr.find_if_not(char_class::space));
+    EXPECT_EQ(2, sr.find_if(char_class::alnum));
+    EXPECT_EQ(8, sr.find_if(char_class::digit));
+    EXPECT_EQ(9, sr.rfind_if(char_class::digit));
+    EXPECT_EQ(9, sr.rfind_if_not(char_class::space));
+    EXPECT_EQ(10, sr.rfind_if(char_class::space));
+    EXPECT_EQ(1, sr.rfind_if(char_class::space, 4));
+    EXPECT_EQ(string_ref::npos, sr.find_if(char_class::digit, 10));
+    EXPECT_STREQ("42", string_ref("42abc").take_front_while(char_class::digit).to_string().c_str());
+    EXPECT_STREQ("", string_ref("abc").take_front_while(char_class::digit).to_string().c_str());
+    // long inputs go through the vector kernels: compare with the scalar loop
+    std::string text;
+    for (int i = 0; i < 300; ++i) { text += " \t\n\v\f\r09azAZ/:@[`{\x7f\x80\xff"[i * 7 % 23]; }
+    string_ref tr(text);
+    auto isSpace = [](char c) { return std::strchr(" \t\n\v\f\r", c) && c; };
+    auto isDigit = [](char c) { return c >= '0' && c <= '9'; };
+    auto isAlnum = [](char c) { return std::isalnum((unsigned char)c) != 0; };
+    for (size_t start = 0; start < 300; start += 13) {
+        EXPECT_EQ(tr.find_if(isSpace, start), tr.find_if(char_class::space, start));
+        EXPECT_EQ(tr.find_if_not(isSpace, start), tr.find_if_not(char_class::space, start));
+        EXPECT_EQ(tr.find_if(isDigit, start), tr.find_if(char_class::digit, start));
+        EXPECT_EQ(tr.find_if_not(isAlnum, start), tr.find_if_not(char_class::alnum, start));
+        EXPECT_EQ(tr.rfind_if(isDigit, start), tr.rfind_if(char_class::digit, start));
+        EXPECT_EQ(tr.rfind_if_not(isAlnum, start), tr.rfind_if_not(char_class::alnum, start));
+    }
+    std::string digits(100, '7');
+    EXPECT_EQ(string_ref::npos, string_ref(digits).find_if_not(char_class::digit));
+    EXPECT_EQ(100, string_ref(digits).take_front_while(char_class::alnum).size());
+}
+
+TEST_P(StringRefKernelTest, FindFirstOf) {
+    string_ref sr("key = value; x=1");
+    EXPECT_EQ(4, sr.find_first_of("=;"));
+    EXPECT_EQ(11, sr.find_first_of("=;", 5));
+    EXPECT_EQ(3, sr.find_first_of(" "));
+    EXPECT_EQ(string_ref::npos, sr.find_first_of(""));
+    EXPECT_EQ(string_ref::npos, sr.find_first_of("=", 100));
+    EXPECT_EQ(3, sr.find_first_not_of("abcdefghijklmnopqrstuvwxyz"));
+    EXPECT_EQ(2, sr.find_first_not_of("", 2));
+    EXPECT_EQ(14, sr.find_last_of("=;"));
+    EXPECT_EQ(11, sr.find_last_of("=;", 13));
+    EXPECT_EQ(4, sr.find_last_of("=", 10));
+    EXPECT_EQ(13, sr.find_last_not_of("=1"));
+    EXPECT_EQ(string_ref::npos, sr.find_last_not_of("yek", 2));
+    EXPECT_EQ(string_ref::npos, string_ref().find_last_of("a"));
+    EXPECT_EQ(string_ref::npos, string_ref().find_first_not_of("a"));
+    adt::char_set delims(" =;");
+    EXPECT_TRUE(delims.contains(';'));
+    EXPECT_FALSE(delims.contains('x'));
+    EXPECT_EQ(3, sr.find_first_of(delims));
+    EXPECT_EQ(12, sr.find_last_of(delims, 13));
+    EXPECT_EQ(6, sr.find_first_not_of(delims, 3));
+    // long inputs with sets of all sizes and high bytes: compare with a bitmap loop
+    std::string text;
+    for (int i = 0; i < 500; ++i) { text += (char)(i * 37 % 256); }
+    string_ref tr(text);
+    const char *sets[] = { "\x80", "\xff\x01", "aeiou", "0123456789abcdefABCDEF",
+                           "\x10\x20\x30\x40\x50\x60\x70\x90\xa0\xb0\xc0\xd0\xe0\xf0" };
+    for (const char *set : sets) {
+        auto in = [set](char c) { return c != '\0' && std::strchr(set, c) != nullptr; };
+        for (size_t start = 0; start < 500; start += 17) {
+            EXPECT_EQ(tr.find_if(in, start), tr.find_first_of(set, start));
+            EXPECT_EQ(tr.find_if_not(in, start), tr.find_first_not_of(set, start));
+            EXPECT_EQ(tr.rfind_if(in, start), tr.find_last_of(set, start));
+            EXPECT_EQ(tr.rfind_if_not(in, start), tr.find_last_not_of(set, start));
+        }
+    }
+    std::string all;
+    for (int c = 0; c < 256; ++c) { all += (char)c; }
+    string_ref allr(all);
+    EXPECT_EQ(string_ref::npos, allr.find_first_not_of(adt::char_set(allr)));
+    EXPECT_EQ(255, allr.find_last_of(adt::char_set(allr)));
+    EXPECT_EQ(0, allr.find_first_of(string_ref("\0", 1)));
+}
+
 TEST(StringRefTest, EditDistance) {
     string_ref s0(""), s1("sea");
     EXPECT_EQ(0, s0.edit_distance(""));
@@ -86,6 +301,87 @@ TEST(StringRefTest, EditDistance) {
     EXPECT_EQ(8, edit_distance("same", "different"));
 }
 
+/* textbook O(m*n) dynamic programming, the reference for the fast versions */
+static size_t naiveEditDistance(const std::string &a, const std::string &b) {
+    std::vector<size_t> prev(b.size() + 1), cur(b.size() + 1);
+    for (size_t j = 0; j <= b.size(); ++j) { prev[j] = j; }
+    for (size_t i = 1; i <= a.size(); ++i) {
+        cur[0] = i;
+        for (size_t j = 1; j <= b.size(); ++j) {
+            cur[j] = std::min(prev[j - 1] + (a[i - 1] != b[j - 1]),
+                              std::min(prev[j], cur[j - 1]) + 1);
+        }
+        std::swap(prev, cur);
+    }
+    return prev[b.size()];
+}
+
+TEST(StringRefTest, EditDistanceLong) {
+    // lengths around the 64-character word boundary and multiple words
+    unsigned seed = 7;
+    auto next = [&seed]() { seed = seed * 1103515245 + 12345; return seed >> 16; };
+    for (size_t m : { 1, 10, 63, 64, 65, 127, 128, 200 }) {
+        for (size_t n : { 0, 5, 64, 100, 190 }) {
+            std::string a, b;
+            for (size_t i = 0; i < m; ++i) { a += "acgt"[next() % 4]; }
+            for (size_t i = 0; i < n; ++i) { b += "acgt"[next() % 4]; }
+            EXPECT_EQ(naiveEditDistance(a, b), edit_distance(a, b));
+            EXPECT_EQ(naiveEditDistance(a, b), edit_distance(b, a));
+            std::string upper = b;
+            for (char &c : upper) { c -= 'a' - 'A'; }
+            EXPECT_EQ(naiveEditDistance(a, b), edit_distance(a, upper, false));
+        }
+    }
+    std::string longA(300, 'x'), longB(300, 'x');
+    longB[150] = 'y';
+    EXPECT_EQ(1, edit_distance(longA, longB));
+    EXPECT_EQ(300, edit_distance(longA, ""));
+}
+
+TEST(StringRefTest, EditDistanceWithin) {
+    EXPECT_TRUE(edit_distance_within("sea", "eat", 2));
+    EXPECT_FALSE(edit_distance_within("sea", "eat", 1));
+    EXPECT_TRUE(edit_distance_within("", "", 0));
+    EXPECT_TRUE(edit_distance_within("abc", "abc", 0));
+    EXPECT_FALSE(edit_distance_within("abc", "abcdef", 2));
+    EXPECT_TRUE(edit_distance_within("abc", "abcdef", 3));
+    EXPECT_TRUE(string_ref("Abcd").edit_distance_within("abcd", 0, false));
+    EXPECT_FALSE(string_ref("Abcd").edit_distance_within("abcd", 0, true));
+    EXPECT_TRUE(edit_distance_within("same", "different", 100));
+    // every threshold around the true distance, narrow and wide bands
+    unsigned seed = 11;
+    auto next = [&seed]() { seed = seed * 1103515245 + 12345; return seed >> 16; };
+    for (size_t m : { 3, 30, 90 }) {
+        for (size_t n : { 3, 31, 100 }) {
+            std::string a, b;
+            for (size_t i = 0; i < m; ++i) { a += "ab"[next() % 2]; }
+            for (size_t i = 0; i < n; ++i) { b += "ab"[next() % 2]; }
+            size_t dist = naiveEditDistance(a, b);
+            for (size_t k = dist > 3 ? dist - 3 : 0; k <= dist + 3; ++k) {
+                EXPECT_EQ(dist <= k, edit_distance_within(a, b, k));
+                EXPECT_EQ(dist <= k, edit_distance_within(b, a, k));
+            }
+        }
+    }
+    // thresholds near the lengths of long strings: wider than the bit vectors
+    for (size_t m : { 70, 150 }) {
+        for (size_t n : { 90, 400 }) {
+            std::string a, b, other(n, 'z');
+            for (size_t i = 0; i < m; ++i) { a += "abcd"[next() % 4]; }
+            for (size_t i = 0; i < n; ++i) { b += "abcd"[next() % 4]; }
+            size_t dist = naiveEditDistance(a, b);
+            for (size_t k = dist - 3; k <= dist + 3; ++k) {
+                EXPECT_EQ(dist <= k, edit_distance_within(a, b, k));
+                EXPECT_EQ(dist <= k, edit_distance_within(b, a, k));
+            }
+            // no common character: the distance is the longer length
+            size_t longer = std::max(m, n);
+            EXPECT_TRUE(edit_distance_within(a, other, longer));
+            EXPECT_FALSE(edit_distance_within(a, other, longer - 1));
+        }
+    }
+}
+
 TEST(StringRefTest, SubString) {
     string_ref sr("abcdefgh");
     // [start, start + num) INTERSECT [0, len)
@@ -167,6 +463,111 @@ TEST(StringRefTest, Split) {
     EXPECT_STREQ("", srPairz4.second.to_string().c_str());
 }
 
+/* "token|token|..." list, for readable expectations */
+static std::string joinTokens(split_view tokens) {
+    std::string res;
+    for (auto it = tokens.begin(); it != tokens.end(); ++it) {
+        if (it != tokens.begin()) { res += "|"; }
+        res += it->to_string();
+    }
+    return res;
+}
+
+TEST(StringRefTest, SplitView) {
+    string_ref csv("a,bc,,d,");
+    EXPECT_EQ("a|bc||d|", joinTokens(csv.split_all(',')));
+    EXPECT_EQ("a|bc|d", joinTokens(csv.split_all(',', string_ref::npos, true)));
+    EXPECT_EQ("a|bc,,d,", joinTokens(csv.split_all(',', 1)));
+    EXPECT_EQ("a,bc,,d,", joinTokens(csv.split_all(',', 0)));
+    EXPECT_EQ("a|bc|d,", joinTokens(csv.split_all(',', 2, true)));
+    EXPECT_EQ("a,bc,,d,", joinTokens(csv.split_all(';')));
+    EXPECT_EQ("", joinTokens(string_ref().split_all(',')));
+    EXPECT_EQ(1, std::distance(string_ref().split_all(',').begin(),
+                               string_ref().split_all(',').end()));
+    EXPECT_EQ(0, std::distance(string_ref("").split_all(',', string_ref::npos, true).begin(),
+                               string_ref("").split_all(',', string_ref::npos, true).end()));
+    // string separators
+    string_ref text("key: value:: more:");
+    EXPECT_EQ("key|value:|more:", joinTokens(text.split_all(": ")));
+    EXPECT_EQ("key| value:: more:", joinTokens(text.split_all(":", 1)));
+    EXPECT_EQ("key: value:: more:", joinTokens(text.split_all(string_ref(""))));
+    EXPECT_EQ("a|b|c", joinTokens(string_ref("a<>b<>c").split_all("<>")));
+    // separator sets
+    string_ref words("  the quick\tbrown\n\nfox ");
+    EXPECT_EQ("the|quick|brown|fox",
+              joinTokens(words.split_any_of(" \t\n", string_ref::npos, true)));
+    EXPECT_EQ("the|quick\tbrown\n\nfox ",
+              joinTokens(words.split_any_of(" \t\n", 1, true)));
+    EXPECT_EQ("||the|quick\tbrown\n\nfox ", joinTokens(words.split_any_of(" \t\n", 3)));
+    // range-for
+    size_t fields = 0;
+    for (string_ref field : string_ref("1,2,3").split_all(',')) {
+        EXPECT_EQ(1, field.size());
+        ++fields;
+    }
+    EXPECT_EQ(3, fields);
+}
+
+TEST_P(StringRefKernelTest, AsciiCase) {
+    char buf[] = "Hello, World! @[`{ 123";
+    adt::ascii_tolower(buf, 5);
+    EXPECT_STREQ("hello, World! @[`{ 123", buf);
+    adt::ascii_toupper(buf, sizeof(buf) - 1);
+    EXPECT_STREQ("HELLO, WORLD! @[`{ 123", buf);
+    adt::cstr_tolower(buf);
+    EXPECT_STREQ("hello, world! @[`{ 123", buf);
+    char out[4] = "xyz";
+    adt::ascii_toupper(out, string_ref("aB", 2));
+    EXPECT_STREQ("ABz", out);
+    // every byte, at every length and offset the vector kernels treat differently
+    std::string all;
+    for (int i = 0; i < 3; ++i) {
+        for (int c = 0; c < 256; ++c) { all += (char)c; }
+    }
+    for (size_t n = 0; n < 200; n += 7) {
+        for (size_t off = 0; off < 3; ++off) {
+            string_ref src(all.data() + off * 85, n);
+            std::string lower(n, '\0'), upper(n, '\0');
+            adt::ascii_tolower(&lower[0], src);
+            adt::ascii_toupper(&upper[0], src);
+            for (size_t i = 0; i != n; ++i) {
+                EXPECT_EQ((char)std::tolower((unsigned char)src[i]), lower[i]);
+                EXPECT_EQ((char)std::toupper((unsigned char)src[i]), upper[i]);
+            }
+            std::string inPlace = src.to_string();
+            adt::ascii_toupper(&inPlace[0], inPlace.size());
+            EXPECT_EQ(upper, inPlace);
+        }
+    }
+}
+
+TEST_P(StringRefKernelTest, Lines) {
+    std::vector<std::string> lines;
+    for (string_ref line : string_ref("a\nbc\r\n\n\r\nd").lines()) {
+        lines.push_back(line.to_string());
+    }
+    EXPECT_EQ((std::vector<std::string>{ "a", "bc", "", "", "d" }), lines);
+    lines.clear();
+    for (string_ref line : string_ref("x\r\ny\n").lines()) { lines.push_back(line.to_string()); }
+    EXPECT_EQ((std::vector<std::string>{ "x", "y" }), lines);
+    lines.clear();
+    for (string_ref line : string_ref("\n").lines()) { lines.push_back(line.to_string()); }
+    EXPECT_EQ((std::vector<std::string>{ "" }), lines);
+    string_ref empty;
+    EXPECT_TRUE(empty.lines().begin() == empty.lines().end());
+    string_ref lone("a\r");  // a '\r' not followed by '\n' stays
+    EXPECT_EQ(string_ref("a\r"), *lone.lines().begin());
+    // long text: the same lines as splitting on '\n' by hand
+    std::string text;
+    for (int i = 0; i < 500; ++i) { text += std::string(i % 97, 'x') + (i % 3 ? "\n" : "\r\n"); }
+    size_t count = 0;
+    for (string_ref line : string_ref(text).lines()) {
+        EXPECT_EQ(count % 97, line.size());
+        ++count;
+    }
+    EXPECT_EQ(500, count);
+}
+
 TEST(StringRefTest, OperatorOverloading) {
     EXPECT_TRUE(string_ref("abc") == string_ref("abc"));
     EXPECT_TRUE(string_ref("abc") != string_ref("abd"));
@@ -181,6 +582,131 @@ TEST(StringRefTest, OperatorOverloading) {
     EXPECT_STREQ("abcde", (s+="de").c_str());
     string_ref sr(s,2);
     EXPECT_STREQ("abcdeab", (s+=sr).c_str());
+    EXPECT_STREQ("abcdeab", s.c_str());  // += appends to s itself
+    EXPECT_STREQ("abcdeabxy", (s + string_ref("xy")).c_str());
+    EXPECT_STREQ("abcdeab", s.c_str());
+    EXPECT_STREQ("qab", (std::string("q") + sr).c_str());
+    (s += string_ref("1")) += string_ref("2");
+    EXPECT_STREQ("abcdeab12", s.c_str());
+}
+
+TEST(StringRefTest, Hash) {
+    std::string s1("the quick brown fox jumps over the lazy dog");
+    for (size_t n = 0; n <= s1.size(); ++n) {
+        std::string s2 = s1.substr(0, n); // a copy elsewhere in memory
+        EXPECT_EQ(string_ref::Hash{}(string_ref(s1, n)), string_ref::Hash{}(s2));
+        EXPECT_EQ(std::hash<string_ref>{}(s2), string_ref::Hash{}(s2));
+        if (n > 0) {
+            EXPECT_NE(string_ref::Hash{}(string_ref(s1, n - 1)), string_ref::Hash{}(s2));
+        }
+    }
+    EXPECT_EQ(string_ref::Hash{}(""), string_ref::Hash{}(string_ref()));
+    EXPECT_NE(string_ref::SeededHash{1}("abc"), string_ref::SeededHash{2}("abc"));
+    EXPECT_EQ(string_ref::SeededHash{0}("abc"), hash_bytes("abc", 3));
+    // wyhash final 4 test vectors: values must not change across builds
+    EXPECT_EQ(0x93228a4de0eec5a2ull, hash_bytes("", 0, 0));
+    EXPECT_EQ(0xc5bac3db178713c4ull, hash_bytes("a", 1, 1));
+    EXPECT_EQ(0xa97f2f7b1d9b3314ull, hash_bytes("abc", 3, 2));
+    EXPECT_EQ(0x786d1f1df3801df4ull, hash_bytes("message digest", 14, 3));
+    EXPECT_EQ(0xdca5a8138ad37c87ull, string_ref::SeededHash{4}("abcdefghijklmnopqrstuvwxyz"));
+    EXPECT_EQ(0x6cc5eab49a92d617ull, string_ref::SeededHash{6}(
+        "1234567890123456789012345678901234567890"
+        "1234567890123456789012345678901234567890"));
+    std::unordered_map<string_ref, int> map;
+    map["key"] = 1;
+    std::string key("key");
+    EXPECT_EQ(1, map[key]);
+}
+
+TEST(StringRefTest, Constexpr) {
+#if ADT_HAS_CONSTANT_EVALUATED
+    constexpr string_ref get("GET"), host = "Host: x\0y"_sr;
+    static_assert(get.size() == 3 && !get.empty() && get[1] == 'E', "");
+    static_assert(host.size() == 9 && host.back() == 'y', "");  // keeps the '\0'
+    static_assert(get == "GET" && get != "GE" && get < "GEU" && "GE" < get, "");
+    static_assert(get.compare("GET") == 0 && get.compare("GEA") == 1, "");
+    static_assert(get.compare("GETS") == -1 && get.compare("\xff") == -1, "");
+    static_assert(get.equals("GET"_sr) && get.starts_with("GE") && get.ends_with("ET"), "");
+    static_assert(!get.starts_with("GETS") && !get.ends_with("GE"), "");
+    static_assert(host.find(':') == 4 && host.find('z') == string_ref::npos, "");
+    static_assert(host.find(' ', 5) == 5 && host.find("x\0y"_sr) == 6, "");
+    static_assert(host.find("") == 0 && host.find("Hosts") == string_ref::npos, "");
+    static_assert(host.contains("st") && host.substr(6).size() == 3, "");
+    static_assert(host.take_front(4) == "Host" && host.drop_back(5) == "Host", "");
+    // the constant-expression hash gives the run-time values
+    static_assert(hash_bytes("", 0, 0) == 0x93228a4de0eec5a2ull, "");
+    static_assert(hash_bytes("abc", 3, 2) == 0xa97f2f7b1d9b3314ull, "");
+    static_assert(string_ref::SeededHash{4}("abcdefghijklmnopqrstuvwxyz")
+                  == 0xdca5a8138ad37c87ull, "");
+    static_assert(string_ref::SeededHash{6}(
+        "1234567890123456789012345678901234567890"
+        "1234567890123456789012345678901234567890") == 0x6cc5eab49a92d617ull, "");
+    static_assert(string_ref::HashInsensitive{}("Content-Type")
+                  == string_ref::Hash{}("content-type"), "");
+    constexpr size_t hosts[] = { string_ref::Hash{}("Host"), string_ref::Hash{}("Host: x\0y"_sr) };
+#else
+    // this compiler cannot evaluate them as constants (see compiler.h)
+    const size_t hosts[] = { string_ref::Hash{}("Host"), string_ref::Hash{}("Host: x\0y"_sr) };
+#endif
+    std::string h("Host: x");
+    h += '\0';
+    h += 'y';
+    EXPECT_EQ(string_ref::Hash{}(string_ref(h, 4)), hosts[0]);
+    EXPECT_EQ(string_ref::Hash{}(h), hosts[1]);
+    // and the run-time paths still agree
+    string_ref rt(h);
+    EXPECT_EQ(6, rt.find("x\0y"_sr));
+    EXPECT_TRUE(rt.starts_with("Host") && rt.ends_with("x\0y"_sr));
+}
+
+TEST_P(StringRefKernelTest, CaseInsensitive) {
+    string_ref sr("Content-Type: Text/HTML");
+    EXPECT_TRUE(sr.equals_insensitive("content-type: text/html"));
+    EXPECT_FALSE(sr.equals_insensitive("content-type: text/htm"));
+    EXPECT_TRUE(string_ref().equals_insensitive(""));
+    EXPECT_FALSE(string_ref("@").equals_insensitive("`"));  // 0x40 vs 0x60
+    EXPECT_FALSE(string_ref("\xc0").equals_insensitive("\xe0"));
+    EXPECT_TRUE(sr.starts_with_insensitive("CONTENT-"));
+    EXPECT_FALSE(string_ref("con").starts_with_insensitive("CONTENT-"));
+    EXPECT_TRUE(sr.ends_with_insensitive("/html"));
+    EXPECT_EQ(0, string_ref("ABC").compare_insensitive("abc"));
+    EXPECT_EQ(-1, string_ref("abc").compare_insensitive("ABD"));
+    EXPECT_EQ(1, string_ref("abcd").compare_insensitive("ABC"));
+    EXPECT_EQ(-1, string_ref("_").compare_insensitive("A"));  // as if lower-cased
+    EXPECT_EQ(14, sr.find_insensitive("TEXT"));
+    EXPECT_EQ(19, sr.find_insensitive("html"));
+    EXPECT_EQ(string_ref::npos, sr.find_insensitive("type", 9));
+    EXPECT_EQ(5, sr.find_insensitive("", 5));
+    EXPECT_EQ(string_ref::npos, sr.find_insensitive("", 100));
+    // long inputs: compare with lower-cased copies
+    std::string text;
+    for (int i = 0; i < 400; ++i) { text += "aBzZ@[`{09 xX\x80\xc1\xe1"[i * 5 % 16]; }
+    std::string lower = text;
+    adt::ascii_tolower(&lower[0], lower.size());
+    string_ref tr(text), lr(lower);
+    for (size_t start = 0; start + 20 < 400; start += 23) {
+        string_ref pattern = tr.substr(start, 11 + start % 30);
+        std::string upper = pattern.to_string();
+        adt::ascii_toupper(&upper[0], upper.size());
+        std::string lowerPattern = upper;
+        adt::ascii_tolower(&lowerPattern[0], lowerPattern.size());
+        EXPECT_EQ(lr.find_str(lowerPattern), tr.find_insensitive(upper));
+        EXPECT_EQ(lr.substr(start).find_str(lowerPattern) + start,
+                  tr.find_insensitive(upper, start));
+        EXPECT_TRUE(tr.substr(start).starts_with_insensitive(upper));
+        EXPECT_EQ(0, lr.substr(start, upper.size()).compare_insensitive(upper));
+    }
+    EXPECT_TRUE(tr.equals_insensitive(lr));
+    // the insensitive hash is the hash of the lower-cased bytes
+    for (size_t n = 0; n <= 100; n += 3) {
+        EXPECT_EQ(adt::hash_bytes(lower.data(), n),
+                  adt::hash_bytes_insensitive(text.data(), n));
+    }
+    std::unordered_map<string_ref, int, string_ref::HashInsensitive,
+                       string_ref::EqualInsensitive> map;
+    map["Key"] = 1;
+    EXPECT_EQ(1, map.count("KEY"));
+    EXPECT_EQ(0, map.count("KEYS"));
 }
 
 int main(int argc, char **argv) {
@@ -0,0 +1,128 @@
+/**
+ * File: string-searcher-test.cc
+ * ---------------------------
+ * Test driver for class string_ref_searcher.
+ */
+
+#include "adt/string-searcher.h"
+#include <gtest/gtest.h>
+#include <algorithm>
+using namespace adt;
+
+TEST(StringRefSearcherTest, Find) {
+    string_ref hay("abcdefabcdef");
+    string_ref_searcher searcher("cd");
+    EXPECT_EQ(2, searcher.find(hay));
+    EXPECT_EQ(2, searcher.find(hay, 2));
+    EXPECT_EQ(8, searcher.find(hay, 3));
+    EXPECT_EQ(string_ref::npos, searcher.find(hay, 9));
+    EXPECT_EQ(string_ref::npos, searcher.find(hay, 100));
+    EXPECT_EQ(string_ref::npos, searcher.find(hay.take_front(3)));
+    EXPECT_EQ(string_ref::npos, searcher.find(string_ref()));
+    EXPECT_EQ(3, string_ref_searcher("d").find(hay));
+    EXPECT_EQ(5, string_ref_searcher("").find(hay, 5));
+    EXPECT_STREQ("cd", searcher.pattern().to_string().c_str());
+}
+
+TEST(StringRefSearcherTest, RFind) {
+    string_ref hay("abcdefabcdef");
+    string_ref_searcher searcher("cd");
+    EXPECT_EQ(8, searcher.rfind(hay));
+    EXPECT_EQ(8, searcher.rfind(hay, 8));
+    EXPECT_EQ(2, searcher.rfind(hay, 7));
+    EXPECT_EQ(string_ref::npos, searcher.rfind(hay, 1));
+    EXPECT_EQ(string_ref::npos, searcher.rfind(string_ref()));
+    EXPECT_EQ(9, string_ref_searcher("d").rfind(hay));
+    EXPECT_EQ(3, string_ref_searcher("d").rfind(hay, 8));
+}
+
+TEST(StringRefSearcherTest, CountAndFindAll) {
+    string_ref hay("aaaabaaa");
+    string_ref_searcher searcher("aa");
+    EXPECT_EQ(5, searcher.count(hay));
+    std::vector<size_t> expected = { 0, 1, 2, 5, 6 };
+    EXPECT_EQ(expected, searcher.find_all(hay));
+    EXPECT_EQ(3, searcher.count(hay, false));
+    std::vector<size_t> disjoint = { 0, 2, 5 };
+    EXPECT_EQ(disjoint, searcher.find_all(hay, false));
+    EXPECT_EQ(0, string_ref_searcher("ab").count("ba"));
+    EXPECT_TRUE(string_ref_searcher("ab").find_all("ba").empty());
+    EXPECT_EQ(3, string_ref_searcher("").count("ab"));
+}
+
+TEST(StringRefSearcherTest, CountPeriodic) {
+    /* matches every m bytes and near-matches everywhere else: a restarted
+     * search would take n * m steps here */
+    std::string hay(1 << 20, 'a');
+    for (size_t m : { 2, 20, 1000 }) {
+        std::string needle(m - 1, 'a');
+        needle += 'b';
+        std::string periodic;
+        while (periodic.size() < hay.size()) { periodic += needle; }
+        string_ref_searcher searcher(needle);
+        EXPECT_EQ(periodic.size() / m, searcher.count(periodic));
+        EXPECT_EQ(periodic.size() / m, searcher.find_all(periodic, false).size());
+        EXPECT_EQ(0, searcher.count(hay));
+        std::string run(m, 'a');
+        string_ref_searcher runs(run);
+        EXPECT_EQ(hay.size() - m + 1, runs.count(hay));
+        EXPECT_EQ(hay.size() / m, runs.count(hay, false));
+        std::vector<size_t> found = runs.find_all(hay, false);
+        ASSERT_EQ(hay.size() / m, found.size());
+        EXPECT_EQ((found.size() - 1) * m, found.back());
+    }
+    std::string overlap("abababa");
+    std::vector<size_t> expected = { 0, 2, 4 }, disjoint = { 0, 4 };
+    EXPECT_EQ(expected, string_ref_searcher("aba").find_all(overlap));
+    EXPECT_EQ(disjoint, string_ref_searcher("aba").find_all(overlap, false));
+}
+
+TEST(StringRefSearcherTest, LongNeedles) {
+    // the same answers as std::string for needles on both sides of the
+    // vector filter / Horspool boundary
+    std::string hay;
+    for (int i = 0; i < 2000; ++i) { hay += "xyzxy"[i % 5] + (i % 11 == 0 ? 1 : 0); }
+    for (size_t m = 1; m <= 80; m += 7) {
+        for (size_t at = 0; at + m <= hay.size(); at += 97) {
+            std::string needle = hay.substr(at, m);
+            string_ref_searcher searcher(needle);
+            EXPECT_EQ(hay.find(needle), searcher.find(hay));
+            EXPECT_EQ(hay.find(needle, at + 1), searcher.find(hay, at + 1));
+            EXPECT_EQ(hay.rfind(needle), searcher.rfind(hay));
+            EXPECT_EQ(hay.rfind(needle, at), searcher.rfind(hay, at));
+        }
+    }
+}
+
+TEST(StringRefSearcherTest, Copy) {
+    std::string hay("the quick brown fox jumps over the lazy dog");
+    std::string longNeedle("jumps over the lazy dog, then jumps back");
+    for (string_ref needle : { string_ref("fox"), string_ref(longNeedle) }) {
+        string_ref_searcher searcher(needle);
+        string_ref_searcher copy(searcher);
+        EXPECT_EQ(searcher.find(hay), copy.find(hay));
+        EXPECT_EQ(searcher.rfind(hay), copy.rfind(hay));
+        copy = string_ref_searcher("lazy");
+        EXPECT_EQ(35, copy.find(hay));
+    }
+}
+
+TEST(StringRefSearcherTest, SearcherSemantics) {
+    std::string hay("the quick brown fox");
+    string_ref_searcher searcher("brown");
+    auto found = searcher(hay.cbegin(), hay.cend());
+    EXPECT_EQ(10, found.first - hay.cbegin());
+    EXPECT_EQ(15, found.second - hay.cbegin());
+    string_ref sr(hay);
+    auto missing = string_ref_searcher("red")(sr.begin(), sr.end());
+    EXPECT_EQ(sr.end(), missing.first);
+    EXPECT_EQ(sr.end(), missing.second);
+    auto empty = string_ref_searcher("")(sr.begin(), sr.end());
+    EXPECT_EQ(sr.begin(), empty.first);
+    EXPECT_EQ(sr.begin(), empty.second);
+}
+
+int main(int argc, char **argv) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
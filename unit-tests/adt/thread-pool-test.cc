@@ -0,0 +1,71 @@
+/**
+ * File: thread-pool-test.cc
+ * ---------------------------
+ * Test driver for class thread_pool.
+ */
+
+#include "adt/thread-pool.h"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <vector>
+using namespace adt;
+
+TEST(ThreadPoolTest, RunsEachIterationOnce) {
+    for (size_t threads : {1, 2, 4, 7}) {
+        thread_pool pool(threads);
+        EXPECT_EQ(threads, pool.size());
+        for (size_t count : {0, 1, 2, 5, 100, 1000}) {
+            std::vector<std::atomic<int> > runs(count);
+            for (auto &r : runs) { r = 0; }
+            pool.parallel_for(count, [&](size_t i) { ++runs[i]; });
+            for (size_t i = 0; i < count; ++i) { EXPECT_EQ(1, runs[i].load()) << i; }
+        }
+    }
+}
+
+TEST(ThreadPoolTest, UnevenWork) {
+    // the first iterations are much longer: the other threads steal the rest
+    thread_pool pool(4);
+    std::atomic<size_t> sum(0);
+    pool.parallel_for(64, [&](size_t i) {
+        volatile size_t spin = 0;
+        for (size_t k = 0; k < (i < 4 ? 2000000 : 1000); ++k) { spin = spin + k; }
+        sum += i;
+    });
+    EXPECT_EQ(64 * 63 / 2, sum.load());
+}
+
+TEST(ThreadPoolTest, ConcurrentCallers) {
+    thread_pool pool(3);
+    std::atomic<size_t> sum(0);
+    std::vector<std::thread> callers;
+    for (int t = 0; t < 4; ++t) {
+        callers.emplace_back([&]() {
+            for (int rep = 0; rep < 50; ++rep) {
+                pool.parallel_for(10, [&](size_t i) { sum += i; });
+            }
+        });
+    }
+    for (std::thread &caller : callers) { caller.join(); }
+    EXPECT_EQ(4 * 50 * 45, sum.load());
+    EXPECT_GE(thread_pool::shared().size(), 1);
+}
+
+TEST(ThreadPoolTest, NestedCalls) {
+    // a task calling back into its own pool must not wait for itself
+    thread_pool pool(3);
+    std::vector<std::atomic<size_t> > sums(8);
+    pool.parallel_for(sums.size(), [&](size_t i) {
+        pool.parallel_for(100, [&](size_t j) { sums[i] += j; });
+    });
+    for (const auto &sum : sums) { EXPECT_EQ(4950, sum.load()); }
+    // and a later top-level call still runs on all threads
+    std::atomic<size_t> total(0);
+    pool.parallel_for(1000, [&](size_t i) { total += i; });
+    EXPECT_EQ(499500, total.load());
+}
+
+int main(int argc, char **argv) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}